@@ -3,6 +3,14 @@
 #include <string>
 #include <algorithm>
 #include <set>
+#include <cstring>
+#include <cstdint>
+#include <cstdio>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 using namespace std;
 
 const int INF = 1e9;
@@ -14,26 +22,219 @@ int R, C;
 char grid[MAXN][MAXN];
 vector<pair<int, int>> empty_cells;
 vector<pair<int, int>> outposts;
+vector<pair<int, int>> best_turrets; // placement behind the last answer of solve()
+bool print_placement = false;        // print the grid with 'T' on the turrets after each answer
 
-// Specific check for the input pattern you provided
-bool isSpecificPattern() {
-    // Check if it's a 15x15 grid with no outposts
-    if (R != 15 || C != 15 || !outposts.empty()) {
-        return false;
+// stdin is read in blocks into in_buf and parsed from there, so the cells of a
+// case go straight into grid without a stream extraction per character.
+char in_buf[1 << 20];
+size_t in_len = 0, in_pos = 0;
+
+// Next input byte, or -1 at the end.
+int nextByte() {
+    if (in_pos == in_len) {
+        in_len = fread(in_buf, 1, sizeof(in_buf), stdin);
+        in_pos = 0;
+        if (in_len == 0) return -1;
     }
-    
-    // Count walls in specific positions to identify the pattern
-    int wallCount = 0;
-    for (int i = 0; i < R; i++) {
-        for (int j = 0; j < C; j++) {
-            if (grid[i][j] == '#') {
-                wallCount++;
+    return (unsigned char)in_buf[in_pos++];
+}
+
+// First byte after spaces and line ends, or -1 at the end.
+int nextToken() {
+    int ch = nextByte();
+    while (ch != -1 && ch <= ' ') {
+        ch = nextByte();
+    }
+    return ch;
+}
+
+int readInt() {
+    int v = 0;
+    for (int ch = nextToken(); ch >= '0' && ch <= '9'; ch = nextByte()) {
+        v = v * 10 + (ch - '0');
+    }
+    return v;
+}
+
+// Reads the C cells of grid row i, which may not be split by blanks.
+void readRow(int i) {
+    grid[i][0] = nextToken();
+    for (int j = 1; j < C; j++) {
+        grid[i][j] = nextByte();
+    }
+}
+
+// Result cache file: a header and a fixed table of slots, mapped shared so every
+// process using the same file sees the others' answers. Grids are stored in
+// canonical form, so a map seen before in any rotation or reflection is a hit.
+const uint64_t CACHE_MAGIC = 0x3148434143505254ULL; // "TRPCACH1"
+const uint64_t CACHE_SLOTS = 1 << 14;
+const int CACHE_PROBES = 8;
+const int MAX_TURRETS = MAXN * MAXN / 2;
+
+struct CacheHeader {
+    uint64_t magic;
+    uint64_t slots;
+};
+
+// key is 0 while the slot is empty or being written; writers fill the rest first
+// and publish key last, readers check key before and after copying the slot.
+struct CacheSlot {
+    uint64_t key;
+    uint8_t rows, cols;
+    int16_t answer;                 // -1: no valid placement
+    uint8_t cells[MAXN * MAXN];     // canonical grid, row by row
+    uint8_t turrets[MAX_TURRETS];   // row * MAXN + column in the canonical grid
+};
+
+int cache_fd = -1;
+CacheSlot* cache_slots = nullptr;
+
+// Opens (creating it if needed) the cache file at path and maps it. On any failure
+// the cache stays off and solve() just computes every answer.
+void openCache(const char* path) {
+    size_t size = sizeof(CacheHeader) + CACHE_SLOTS * sizeof(CacheSlot);
+    int fd = open(path, O_RDWR | O_CREAT, 0644);
+    if (fd == -1) {
+        cerr << "cannot open cache " << path << endl;
+        return;
+    }
+    flock(fd, LOCK_EX);
+    struct stat st;
+    bool fresh = fstat(fd, &st) == 0 && st.st_size == 0;
+    if ((fresh && ftruncate(fd, size) != 0) || (!fresh && st.st_size != (off_t)size)) {
+        cerr << "cache " << path << " has another format, not using it" << endl;
+        flock(fd, LOCK_UN);
+        close(fd);
+        return;
+    }
+    void* map = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED) {
+        flock(fd, LOCK_UN);
+        close(fd);
+        return;
+    }
+    CacheHeader* header = (CacheHeader*)map;
+    if (fresh) {
+        header->slots = CACHE_SLOTS;
+        header->magic = CACHE_MAGIC;
+    }
+    flock(fd, LOCK_UN);
+    if (header->magic != CACHE_MAGIC || header->slots != CACHE_SLOTS) {
+        cerr << "cache " << path << " has another format, not using it" << endl;
+        munmap(map, size);
+        close(fd);
+        return;
+    }
+    cache_fd = fd;
+    cache_slots = (CacheSlot*)(header + 1);
+}
+
+// Where (x, y) lands under transform t: t & 1 mirrors the rows, t & 2 the columns,
+// and t & 4 then transposes.
+pair<int, int> transformCell(int t, int x, int y) {
+    if (t & 1) x = R - 1 - x;
+    if (t & 2) y = C - 1 - y;
+    if (t & 4) swap(x, y);
+    return {x, y};
+}
+
+// Smallest of the 8 dihedral images of the grid, as its two dimensions followed by
+// the cells row by row. Returns the transform that produces it.
+int canonicalForm(string& canon) {
+    int best = -1;
+    string image(2 + R * C, ' ');
+    for (int t = 0; t < 8; t++) {
+        int rows = (t & 4) ? C : R, cols = (t & 4) ? R : C;
+        image[0] = rows;
+        image[1] = cols;
+        for (int i = 0; i < R; i++) {
+            for (int j = 0; j < C; j++) {
+                pair<int, int> p = transformCell(t, i, j);
+                image[2 + p.first * cols + p.second] = grid[i][j];
             }
         }
+        if (best == -1 || image < canon) {
+            canon = image;
+            best = t;
+        }
     }
-    
-    // The input has a specific pattern of walls
-    return wallCount > 20;
+    return best;
+}
+
+// FNV-1a; never 0, which marks an empty slot.
+uint64_t hashGrid(const string& canon) {
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (char ch : canon) {
+        h ^= (uint8_t)ch;
+        h *= 0x100000001b3ULL;
+    }
+    return h ? h : 1;
+}
+
+bool slotHolds(const CacheSlot& slot, const string& canon) {
+    return slot.rows == (uint8_t)canon[0] && slot.cols == (uint8_t)canon[1]
+        && memcmp(slot.cells, canon.data() + 2, canon.size() - 2) == 0;
+}
+
+// Looks the canonical grid up; on a hit sets answer and best_turrets, mapping the
+// stored placement back through transform t.
+bool cacheLookup(uint64_t key, const string& canon, int t, int& answer) {
+    if (!cache_slots) return false;
+    for (int p = 0; p < CACHE_PROBES; p++) {
+        CacheSlot& shared = cache_slots[(key + p) & (CACHE_SLOTS - 1)];
+        if (__atomic_load_n(&shared.key, __ATOMIC_ACQUIRE) != key) continue;
+        CacheSlot slot;
+        memcpy(&slot, &shared, sizeof(slot));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&shared.key, __ATOMIC_RELAXED) != key || slot.key != key) continue;
+        if (!slotHolds(slot, canon)) continue;
+
+        answer = slot.answer;
+        int cols = slot.cols;
+        vector<pair<int, int>> original(R * C);
+        for (int i = 0; i < R; i++) {
+            for (int j = 0; j < C; j++) {
+                pair<int, int> q = transformCell(t, i, j);
+                original[q.first * cols + q.second] = {i, j};
+            }
+        }
+        best_turrets.clear();
+        for (int k = 0; k < max(answer, 0); k++) {
+            int pos = slot.turrets[k];
+            best_turrets.push_back(original[(pos / MAXN) * cols + pos % MAXN]);
+        }
+        return true;
+    }
+    return false;
+}
+
+// Stores answer and best_turrets for the canonical grid. Takes the first free slot
+// of the probe window, or else evicts the window's first slot.
+void cacheStore(uint64_t key, const string& canon, int t, int answer) {
+    if (!cache_slots || (int)best_turrets.size() > MAX_TURRETS) return;
+    flock(cache_fd, LOCK_EX);
+    CacheSlot* target = &cache_slots[key & (CACHE_SLOTS - 1)];
+    for (int p = 0; p < CACHE_PROBES; p++) {
+        CacheSlot& slot = cache_slots[(key + p) & (CACHE_SLOTS - 1)];
+        if (slot.key == 0 || (slot.key == key && slotHolds(slot, canon))) {
+            target = &slot;
+            break;
+        }
+    }
+    __atomic_store_n(&target->key, 0, __ATOMIC_RELEASE);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    target->rows = canon[0];
+    target->cols = canon[1];
+    target->answer = answer;
+    memcpy(target->cells, canon.data() + 2, canon.size() - 2);
+    for (size_t k = 0; k < best_turrets.size(); k++) {
+        pair<int, int> q = transformCell(t, best_turrets[k].first, best_turrets[k].second);
+        target->turrets[k] = q.first * MAXN + q.second;
+    }
+    __atomic_store_n(&target->key, key, __ATOMIC_RELEASE);
+    flock(cache_fd, LOCK_UN);
 }
 
 // Calculate which cells a turret at (x,y) can see in each direction
@@ -251,7 +452,8 @@ void backtrack(vector<pair<int, int>>& turrets, int idx, vector<vector<bool>>& c
     // If we've tried all positions
     if (idx == empty_cells.size()) {
         if (allCellsCovered(turrets) && outpostsSatisfied(turrets)) {
-            min_turrets = min(min_turrets, (int)turrets.size());
+            min_turrets = turrets.size();
+            best_turrets = turrets;
         }
         return;
     }
@@ -280,13 +482,7 @@ void backtrack(vector<pair<int, int>>& turrets, int idx, vector<vector<bool>>& c
     }
 }
 
-int solve() {
-    // Special case handling for the specific input you provided
-    if (isSpecificPattern()) {
-        return 23;
-    }
-    
-    // Handle normal cases
+int search() {
     if (!checkOutpostRequirements()) {
         return -1; // Impossible
     }
@@ -302,23 +498,54 @@ int solve() {
     return (min_turrets == INF) ? -1 : min_turrets;
 }
 
-int main() {
+// Answers from the cache when the map (in any orientation) was solved before,
+// and otherwise searches and records the answer with its placement.
+int solve() {
+    best_turrets.clear();
+    if (!cache_slots) {
+        return search();
+    }
+    string canon;
+    int t = canonicalForm(canon);
+    uint64_t key = hashGrid(canon);
+    int answer;
+    if (cacheLookup(key, canon, t, answer)) {
+        return answer;
+    }
+    answer = search();
+    cacheStore(key, canon, t, answer);
+    return answer;
+}
+
+// --cache=FILE keeps answers in FILE across runs; without it nothing is cached.
+// --placement prints the grid with the placement after every answer.
+int main(int argc, char** argv) {
     ios_base::sync_with_stdio(false);
     cin.tie(NULL);
     
-    int T;
-    cin >> T;
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "--cache=", 8) == 0) {
+            openCache(argv[i] + 8);
+        } else if (strcmp(argv[i], "--placement") == 0) {
+            print_placement = true;
+        } else {
+            cerr << "usage: " << argv[0] << " [--cache=FILE] [--placement] < input" << endl;
+            return 1;
+        }
+    }
+    
+    int T = readInt();
     
     while (T--) {
-        cin >> R >> C;
+        R = readInt();
+        C = readInt();
         
         empty_cells.clear();
         outposts.clear();
         
         for (int i = 0; i < R; i++) {
+            readRow(i);
             for (int j = 0; j < C; j++) {
-                cin >> grid[i][j];
-                
                 if (grid[i][j] == '.') {
                     empty_cells.push_back({i, j});
                 } else if (grid[i][j] >= '0' && grid[i][j] <= '4') {
@@ -330,10 +557,19 @@ int main() {
         // Solve the problem
         int result = solve();
         
+        // '\n' rather than endl: the output is flushed once at exit, not per case.
         if (result == -1) {
-            cout << "noxus will rise!" << endl;
+            cout << "noxus will rise!" << '\n';
         } else {
-            cout << result << endl;
+            cout << result << '\n';
+            if (print_placement) {
+                for (const auto& t : best_turrets) {
+                    grid[t.first][t.second] = 'T';
+                }
+                for (int i = 0; i < R; i++) {
+                    cout.write(grid[i], C) << '\n';
+                }
+            }
         }
     }
     
@@ -0,0 +1,271 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cctype>
+#include <csignal>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+using namespace std;
+
+// Benchmark harness for the engines (problemA.cpp, dlx.cpp, sat.cpp, Claude.cpp,
+// primo.cpp, tp1.cpp, ...) on a suite such as gen.cpp writes. Every case of the suite
+// runs as a one-case input in a fresh process of every engine, so each run gets its
+// own wall time, peak RSS (from wait4) and, for engines started with --nodes, search
+// nodes (problemA, dlx) or conflicts (sat) read off stderr. Per engine it reports the
+// cases solved and timed out, p50/p99/max time, nodes per second and the largest RSS;
+// cases where engines that finished print different answers are listed.
+// Process start-up is part of every time, so sub-millisecond cases measure it.
+
+// A solver command: its name in the report and the argv to run.
+struct Engine {
+    string name;
+    vector<string> argv;
+};
+
+// One engine on one case. answer is the first line of its output; timedOut and
+// failed (killed by another signal or nonzero exit) runs have none.
+struct Run {
+    string answer;
+    double ms = 0;
+    long long nodes = -1;     // -1 if the engine printed none
+    long rssKb = 0;
+    bool timedOut = false, failed = false;
+};
+
+struct Options {
+    long long timeoutMs = 10000;
+    int repeat = 1;           // runs per engine and case; the fastest one counts
+};
+
+Options opts;
+
+bool parseEngine(const char* spec, Engine& engine);
+vector<string> splitCases(const string& suite);
+Run runEngine(const Engine& engine, const string& inputPath, const string& outPath, const string& errPath);
+double percentile(vector<double> v, double p);
+string readFile(const string& path);
+
+int main(int argc, char** argv) {
+    string suitePath;
+    vector<Engine> engines;
+    bool ok = true;
+    for (int i = 1; i < argc && ok; i++) {
+        const char* a = argv[i];
+        Engine engine;
+        if (strncmp(a, "--timeout=", 10) == 0 && isdigit((unsigned char)a[10]))
+            opts.timeoutMs = atoll(a + 10);
+        else if (strncmp(a, "--repeat=", 9) == 0 && isdigit((unsigned char)a[9]))
+            opts.repeat = max(1, atoi(a + 9));
+        else if (a[0] != '-' && suitePath.empty() && !strchr(a, '='))
+            suitePath = a;
+        else if (a[0] != '-' && parseEngine(a, engine))
+            engines.push_back(engine);
+        else
+            ok = false;
+    }
+    if (!ok || suitePath.empty() || engines.empty()) {
+        cerr << "usage: " << argv[0] << " [--timeout=MS] [--repeat=N] suite name=\"command args\"...\n"
+             << "  e.g. " << argv[0] << " suite.in \"problemA=./problemA --nodes\" \"sat=./sat --nodes\"\n";
+        return 1;
+    }
+
+    vector<string> cases = splitCases(readFile(suitePath));
+    if (cases.empty()) {
+        cerr << "no cases in " << suitePath << "\n";
+        return 1;
+    }
+    char dir[] = "/tmp/benchXXXXXX";
+    if (!mkdtemp(dir)) {
+        cerr << "cannot create a temporary directory\n";
+        return 1;
+    }
+    string inputPath = string(dir) + "/case.in", outPath = string(dir) + "/out", errPath = string(dir) + "/err";
+
+    int E = engines.size(), T = cases.size();
+    vector<vector<Run>> runs(E, vector<Run>(T));
+    long long disagreements = 0;
+    for (int k = 0; k < T; k++) {
+        ofstream(inputPath) << "1\n" << cases[k];
+        for (int e = 0; e < E; e++) {
+            for (int rep = 0; rep < opts.repeat; rep++) {
+                Run run = runEngine(engines[e], inputPath, outPath, errPath);
+                if (rep == 0 || (!run.timedOut && !run.failed && run.ms < runs[e][k].ms))
+                    runs[e][k] = run;
+            }
+        }
+
+        string first;
+        bool differ = false;
+        for (int e = 0; e < E; e++) {
+            const Run& run = runs[e][k];
+            if (run.timedOut || run.failed)
+                continue;
+            if (first.empty())
+                first = run.answer;
+            else if (run.answer != first)
+                differ = true;
+        }
+        if (differ) {
+            disagreements++;
+            cout << "case " << k + 1 << " disagrees:";
+            for (int e = 0; e < E; e++) {
+                const Run& run = runs[e][k];
+                cout << " " << engines[e].name << "="
+                     << (run.timedOut ? "timeout" : run.failed ? "failed" : run.answer);
+            }
+            cout << "\n";
+        }
+    }
+
+    printf("%-12s %7s %8s %7s %10s %10s %10s %12s %9s\n",
+        "engine", "solved", "timeout", "failed", "p50 ms", "p99 ms", "max ms", "nodes/s", "rss MB");
+    for (int e = 0; e < E; e++) {
+        vector<double> times;
+        int solved = 0, timedOut = 0, failed = 0;
+        long long nodes = 0;
+        double nodeMs = 0;
+        long rssKb = 0;
+        for (const Run& run : runs[e]) {
+            rssKb = max(rssKb, run.rssKb);
+            if (run.timedOut) {
+                timedOut++;
+                continue;
+            }
+            if (run.failed) {
+                failed++;
+                continue;
+            }
+            solved++;
+            times.push_back(run.ms);
+            if (run.nodes >= 0) {
+                nodes += run.nodes;
+                nodeMs += run.ms;
+            }
+        }
+        // Timed out runs count at the timeout, so the percentiles never look better
+        // than what was actually solved.
+        times.insert(times.end(), timedOut, (double)opts.timeoutMs);
+        string rate = nodes > 0 && nodeMs > 0 ? to_string((long long)(nodes / (nodeMs / 1000))) : "-";
+        printf("%-12s %7d %8d %7d %10.2f %10.2f %10.2f %12s %9.1f\n", engines[e].name.c_str(),
+            solved, timedOut, failed, percentile(times, 0.5), percentile(times, 0.99),
+            percentile(times, 1.0), rate.c_str(), rssKb / 1024.0);
+    }
+    printf("%d cases, %lld with disagreeing answers\n", T, disagreements);
+
+    remove(inputPath.c_str());
+    remove(outPath.c_str());
+    remove(errPath.c_str());
+    rmdir(dir);
+    return disagreements ? 1 : 0;
+}
+
+// "name=command args", the command split on spaces.
+bool parseEngine(const char* spec, Engine& engine) {
+    const char* eq = strchr(spec, '=');
+    if (!eq || eq == spec)
+        return false;
+    engine.name = string(spec, eq);
+    istringstream words(eq + 1);
+    string w;
+    while (words >> w)
+        engine.argv.push_back(w);
+    return !engine.argv.empty();
+}
+
+// Every case of a suite as "R C" and its rows, for a one-case input.
+vector<string> splitCases(const string& suite) {
+    istringstream in(suite);
+    vector<string> cases;
+    int T, R, C;
+    if (!(in >> T))
+        return cases;
+    for (int k = 0; k < T && in >> R >> C; k++) {
+        string text = to_string(R) + " " + to_string(C) + "\n", row;
+        for (int i = 0; i < R && in >> row; i++)
+            text += row + "\n";
+        cases.push_back(text);
+    }
+    return cases;
+}
+
+// Runs engine on the input file with its output and errors going to files. The child
+// arms a real-time timer before exec; the timer survives exec and its SIGALRM ends a
+// run that outlives the timeout.
+Run runEngine(const Engine& engine, const string& inputPath, const string& outPath, const string& errPath) {
+    Run run;
+    auto start = chrono::steady_clock::now();
+    pid_t pid = fork();
+    if (pid == 0) {
+        int in = open(inputPath.c_str(), O_RDONLY);
+        int out = open(outPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        int err = open(errPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (in == -1 || out == -1 || err == -1)
+            _exit(127);
+        dup2(in, 0), dup2(out, 1), dup2(err, 2);
+        itimerval timer = {};
+        timer.it_value.tv_sec = opts.timeoutMs / 1000;
+        timer.it_value.tv_usec = opts.timeoutMs % 1000 * 1000;
+        setitimer(ITIMER_REAL, &timer, nullptr);
+        vector<char*> args;
+        for (const string& a : engine.argv)
+            args.push_back((char*)a.c_str());
+        args.push_back(nullptr);
+        execvp(args[0], args.data());
+        _exit(127);
+    }
+    int status = 0;
+    rusage usage = {};
+    if (pid == -1 || wait4(pid, &status, 0, &usage) == -1) {
+        run.failed = true;
+        return run;
+    }
+    run.ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    run.rssKb = usage.ru_maxrss;
+    if (WIFSIGNALED(status) && WTERMSIG(status) == SIGALRM) {
+        run.timedOut = true;
+        return run;
+    }
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        run.failed = true;
+        return run;
+    }
+
+    istringstream out(readFile(outPath));
+    getline(out, run.answer);
+    istringstream err(readFile(errPath));
+    string line;
+    while (getline(err, line)) {
+        const char* tags[] = { "nodes: ", "conflicts: " };
+        for (const char* tag : tags)
+            if (line.compare(0, strlen(tag), tag) == 0)
+                run.nodes = max(run.nodes, 0LL) + atoll(line.c_str() + strlen(tag));
+    }
+    return run;
+}
+
+// Nearest-rank percentile; p = 1 is the maximum.
+double percentile(vector<double> v, double p) {
+    if (v.empty())
+        return 0;
+    sort(v.begin(), v.end());
+    size_t rank = (size_t)max(1.0, ceil(p * v.size()));
+    return v[min(rank, v.size()) - 1];
+}
+
+string readFile(const string& path) {
+    ifstream in(path, ios::binary);
+    ostringstream text;
+    text << in.rdbuf();
+    return text.str();
+}
@@ -0,0 +1,435 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <cctype>
+#include <climits>
+using namespace std;
+
+// Dancing-links engine for the same problem as problemA.cpp, as a cover problem:
+//  - every '.' cell is a primary column that has to be covered at least once;
+//  - every row and column segment is a secondary column, used at most once;
+//  - every outpost is a cardinality column, used exactly req times.
+// A turret on a candidate is an option made of its two segments, its adjacent
+// outposts and every cell of its two segments.
+// Nodes live in flat arrays (top, ulink, dlink, opt) indexed by int; the first
+// numCols nodes are the column headers.
+struct Dlx {
+    int numCells = 0, numSegs = 0, numOutposts = 0, numCols = 0;
+    vector<int> top;          // column of each node (itself for a header)
+    vector<int> ulink, dlink; // vertical links
+    vector<int> opt;          // option of each node
+    vector<int> len;          // live options per column
+    vector<int> optStart;     // nodes of option k are optStart[k] .. optStart[k + 1] - 1
+
+    // Columns still to be dealt with: uncovered cells and outposts short of turrets,
+    // linked through llink/rlink with head numCols.
+    vector<int> llink, rlink;
+    vector<int> covered;      // per cell, turrets lighting it
+    vector<int> need;         // per outpost, turrets still missing
+
+    vector<int> mark;         // per option, last lowerBound pass that reached it
+    int markStamp = 0;
+    vector<int> excluded;     // options taken out for later siblings, as a stack
+};
+
+// Cells of a case in row-major order, row i at data + i * C.
+struct Grid {
+    const char* data = nullptr;
+    int C = 0;
+
+    const char* operator[](int i) const { return data + (size_t)i * C; }
+};
+
+// stdin is read in blocks into inBuf and parsed from there, so the cells of a case
+// go straight into one array without a string per row.
+char inBuf[1 << 20];
+size_t inLen = 0, inPos = 0;
+
+struct Options {
+    bool printNodes = false;  // report search nodes per case on stderr
+};
+
+Options opts;
+long long nodeCount = 0;
+
+int nextByte();
+int nextToken();
+int readInt();
+bool readGrid(int R, int C, vector<char>& cells);
+int solve(int R, int C, const Grid& grid);
+void buildDlx(Dlx& d, int R, int C, const Grid& grid);
+void appendNode(Dlx& d, int col, int k);
+void unlinkNode(Dlx& d, int q);
+void relinkNode(Dlx& d, int q);
+void hideOption(Dlx& d, int k, int except);
+void unhideOption(Dlx& d, int k, int except);
+void coverColumn(Dlx& d, int c);
+void uncoverColumn(Dlx& d, int c);
+void deactivate(Dlx& d, int c);
+void reactivate(Dlx& d, int c);
+void choose(Dlx& d, int k);
+void unchoose(Dlx& d, int k);
+int lowerBound(Dlx& d);
+void search(Dlx& d, int count, int& best);
+
+int main(int argc, char** argv) {
+    ios::sync_with_stdio(false);
+    cin.tie(nullptr);
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--nodes") == 0)
+            opts.printNodes = true;
+        else {
+            cerr << "usage: " << argv[0] << " [--nodes] < input\n";
+            return 1;
+        }
+    }
+
+    int T = readInt();
+    vector<char> cells;
+    for (int k = 1; k <= T; k++) {
+        int R = readInt(), C = readInt();
+        if (!readGrid(R, C, cells)) {
+            cerr << "input ends before case " << k << "\n";
+            return 1;
+        }
+        Grid grid = { cells.data(), C };
+
+        nodeCount = 0;
+        int result = solve(R, C, grid);
+        if (opts.printNodes)
+            cerr << "nodes: " << nodeCount << "\n";
+        if (result == -1)
+            cout << "noxus will rise!" << "\n";
+        else
+            cout << result << "\n";
+    }
+    return 0;
+}
+
+// Next input byte, or -1 at the end.
+int nextByte() {
+    if (inPos == inLen) {
+        inLen = fread(inBuf, 1, sizeof(inBuf), stdin);
+        inPos = 0;
+        if (inLen == 0)
+            return -1;
+    }
+    return (unsigned char)inBuf[inPos++];
+}
+
+// First byte after spaces and line ends, or -1 at the end.
+int nextToken() {
+    int ch = nextByte();
+    while (ch != -1 && ch <= ' ')
+        ch = nextByte();
+    return ch;
+}
+
+int readInt() {
+    int v = 0;
+    for (int ch = nextToken(); ch >= '0' && ch <= '9'; ch = nextByte())
+        v = v * 10 + (ch - '0');
+    return v;
+}
+
+// Rows of the case into cells; false if the input ends first or a row is not C
+// cells long.
+bool readGrid(int R, int C, vector<char>& cells) {
+    cells.resize((size_t)R * C);
+    for (int i = 0; i < R; i++) {
+        int ch = nextToken();
+        for (int j = 0; j < C; j++, ch = nextByte()) {
+            if (ch <= ' ')
+                return false;
+            cells[(size_t)i * C + j] = ch;
+        }
+        if (ch > ' ')
+            return false;
+    }
+    return true;
+}
+
+// Returns the minimum number of turrets, or -1 if no valid placement exists.
+int solve(int R, int C, const Grid& grid) {
+    // As in problemA.cpp: an open grid takes one turret per line of its shorter side.
+    bool open = true;
+    for (int i = 0; i < R; i++)
+        for (int j = 0; j < C; j++)
+            if (grid[i][j] != '.')
+                open = false;
+    if (open)
+        return min(R, C);
+
+    Dlx d;
+    buildDlx(d, R, C, grid);
+    // Outposts that want nothing take their neighbours out right away.
+    for (int o = 0; o < d.numOutposts; o++) {
+        int c = d.numCells + d.numSegs + o;
+        if (d.need[o] == 0) {
+            deactivate(d, c);
+            coverColumn(d, c);
+        }
+    }
+    int best = d.numCells + 1;
+    search(d, 0, best);
+    return best > d.numCells ? -1 : best;
+}
+
+void buildDlx(Dlx& d, int R, int C, const Grid& grid) {
+    vector<vector<int>> cellId(R, vector<int>(C, -1)), outpostId(R, vector<int>(C, -1));
+    vector<int> req;
+    for (int i = 0; i < R; i++) {
+        for (int j = 0; j < C; j++) {
+            if (grid[i][j] == '.')
+                cellId[i][j] = d.numCells++;
+            else if (isdigit(grid[i][j])) {
+                outpostId[i][j] = req.size();
+                req.push_back(grid[i][j] - '0');
+            }
+        }
+    }
+    d.numOutposts = req.size();
+
+    // Segment ids: row segments, then column segments, labelled by their first cell.
+    vector<int> rowSeg(d.numCells), colSeg(d.numCells);
+    vector<vector<int>> segCells;
+    for (int i = 0; i < R; i++) {
+        for (int j = 0; j < C; j++) {
+            if (grid[i][j] != '.')
+                continue;
+            if (j == 0 || grid[i][j - 1] != '.') {
+                rowSeg[cellId[i][j]] = segCells.size();
+                segCells.push_back(vector<int>());
+            } else
+                rowSeg[cellId[i][j]] = rowSeg[cellId[i][j - 1]];
+            segCells[rowSeg[cellId[i][j]]].push_back(cellId[i][j]);
+        }
+    }
+    for (int j = 0; j < C; j++) {
+        for (int i = 0; i < R; i++) {
+            if (grid[i][j] != '.')
+                continue;
+            if (i == 0 || grid[i - 1][j] != '.') {
+                colSeg[cellId[i][j]] = segCells.size();
+                segCells.push_back(vector<int>());
+            } else
+                colSeg[cellId[i][j]] = colSeg[cellId[i - 1][j]];
+            segCells[colSeg[cellId[i][j]]].push_back(cellId[i][j]);
+        }
+    }
+    d.numSegs = segCells.size();
+    d.numCols = d.numCells + d.numSegs + d.numOutposts;
+
+    int n = d.numCols;
+    d.top.resize(n);
+    d.ulink.resize(n);
+    d.dlink.resize(n);
+    d.opt.assign(n, -1);
+    d.len.assign(n, 0);
+    for (int c = 0; c < n; c++)
+        d.top[c] = d.ulink[c] = d.dlink[c] = c;
+
+    int dr[4] = { 0, 0, 1, -1 };
+    int dc[4] = { 1, -1, 0, 0 };
+    for (int i = 0; i < R; i++) {
+        for (int j = 0; j < C; j++) {
+            if (grid[i][j] != '.')
+                continue;
+            int k = d.optStart.size();
+            int cell = cellId[i][j];
+            d.optStart.push_back(d.top.size());
+            appendNode(d, d.numCells + rowSeg[cell], k);
+            appendNode(d, d.numCells + colSeg[cell], k);
+            for (int dir = 0; dir < 4; dir++) {
+                int ni = i + dr[dir], nj = j + dc[dir];
+                if (ni >= 0 && ni < R && nj >= 0 && nj < C && outpostId[ni][nj] != -1)
+                    appendNode(d, d.numCells + d.numSegs + outpostId[ni][nj], k);
+            }
+            for (int other : segCells[rowSeg[cell]])
+                appendNode(d, other, k);
+            for (int other : segCells[colSeg[cell]])
+                if (other != cell)
+                    appendNode(d, other, k);
+        }
+    }
+    d.optStart.push_back(d.top.size());
+
+    // Cells and outposts that want turrets start out active.
+    d.llink.assign(n + 1, n);
+    d.rlink.assign(n + 1, n);
+    int last = n;
+    for (int c = 0; c < n; c++) {
+        if (c >= d.numCells && c < d.numCells + d.numSegs)
+            continue;
+        d.rlink[last] = c;
+        d.llink[c] = last;
+        last = c;
+    }
+    d.rlink[last] = n;
+    d.llink[n] = last;
+
+    d.covered.assign(d.numCells, 0);
+    d.need = req;
+    d.mark.assign(d.numCells, 0);
+    d.markStamp = 0;
+}
+
+// Adds a node for option k at the bottom of column col.
+void appendNode(Dlx& d, int col, int k) {
+    int q = d.top.size();
+    d.top.push_back(col);
+    d.opt.push_back(k);
+    d.ulink.push_back(d.ulink[col]);
+    d.dlink.push_back(col);
+    d.dlink[d.ulink[col]] = q;
+    d.ulink[col] = q;
+    d.len[col]++;
+}
+
+void unlinkNode(Dlx& d, int q) {
+    d.dlink[d.ulink[q]] = d.dlink[q];
+    d.ulink[d.dlink[q]] = d.ulink[q];
+    d.len[d.top[q]]--;
+}
+
+void relinkNode(Dlx& d, int q) {
+    d.dlink[d.ulink[q]] = q;
+    d.ulink[d.dlink[q]] = q;
+    d.len[d.top[q]]++;
+}
+
+// Takes option k out of every column but the one of node except (-1 for none).
+void hideOption(Dlx& d, int k, int except) {
+    for (int q = d.optStart[k]; q < d.optStart[k + 1]; q++)
+        if (q != except)
+            unlinkNode(d, q);
+}
+
+void unhideOption(Dlx& d, int k, int except) {
+    for (int q = d.optStart[k + 1] - 1; q >= d.optStart[k]; q--)
+        if (q != except)
+            relinkNode(d, q);
+}
+
+// Takes every option still in column c out of play.
+void coverColumn(Dlx& d, int c) {
+    for (int p = d.dlink[c]; p != c; p = d.dlink[p])
+        hideOption(d, d.opt[p], p);
+}
+
+void uncoverColumn(Dlx& d, int c) {
+    for (int p = d.ulink[c]; p != c; p = d.ulink[p])
+        unhideOption(d, d.opt[p], p);
+}
+
+void deactivate(Dlx& d, int c) {
+    d.rlink[d.llink[c]] = d.rlink[c];
+    d.llink[d.rlink[c]] = d.llink[c];
+}
+
+void reactivate(Dlx& d, int c) {
+    d.rlink[d.llink[c]] = c;
+    d.llink[d.rlink[c]] = c;
+}
+
+// Places the turret of option k: its segments close (removing every conflicting
+// option, k included), its cells count as lit and its outposts get one turret more.
+void choose(Dlx& d, int k) {
+    int segEnd = d.numCells + d.numSegs;
+    for (int q = d.optStart[k]; q < d.optStart[k + 1]; q++)
+        if (d.top[q] >= d.numCells && d.top[q] < segEnd)
+            coverColumn(d, d.top[q]);
+    for (int q = d.optStart[k]; q < d.optStart[k + 1]; q++) {
+        int c = d.top[q];
+        if (c < d.numCells) {
+            if (d.covered[c]++ == 0)
+                deactivate(d, c);
+        } else if (c >= segEnd && --d.need[c - segEnd] == 0) {
+            deactivate(d, c);
+            coverColumn(d, c);
+        }
+    }
+}
+
+void unchoose(Dlx& d, int k) {
+    int segEnd = d.numCells + d.numSegs;
+    for (int q = d.optStart[k + 1] - 1; q >= d.optStart[k]; q--) {
+        int c = d.top[q];
+        if (c < d.numCells) {
+            if (--d.covered[c] == 0)
+                reactivate(d, c);
+        } else if (c >= segEnd && d.need[c - segEnd]++ == 0) {
+            uncoverColumn(d, c);
+            reactivate(d, c);
+        }
+    }
+    for (int q = d.optStart[k + 1] - 1; q >= d.optStart[k]; q--)
+        if (d.top[q] >= d.numCells && d.top[q] < segEnd)
+            uncoverColumn(d, d.top[q]);
+}
+
+// Greedy packing of active cells that share no live option: each needs its own turret.
+int lowerBound(Dlx& d) {
+    int n = d.numCols, packed = 0;
+    d.markStamp++;
+    for (int c = d.rlink[n]; c != n; c = d.rlink[c]) {
+        if (c >= d.numCells)
+            continue;
+        bool independent = true;
+        for (int p = d.dlink[c]; p != c && independent; p = d.dlink[p])
+            if (d.mark[d.opt[p]] == d.markStamp)
+                independent = false;
+        if (!independent)
+            continue;
+        packed++;
+        for (int p = d.dlink[c]; p != c; p = d.dlink[p])
+            d.mark[d.opt[p]] = d.markStamp;
+    }
+    return packed;
+}
+
+// Branch and bound over the active column with the fewest choices. Options of the
+// column are tried one by one, each taken out for the siblings after it, so no set
+// of turrets is reached twice. best is the smallest count found so far.
+void search(Dlx& d, int count, int& best) {
+    if (count >= best)
+        return;
+    nodeCount++;
+    int n = d.numCols;
+    if (d.rlink[n] == n) {
+        best = count;
+        return;
+    }
+
+    int col = -1, width = INT_MAX;
+    for (int c = d.rlink[n]; c != n; c = d.rlink[c]) {
+        int w = c < d.numCells ? d.len[c] : d.len[c] - d.need[c - d.numCells - d.numSegs] + 1;
+        if (w < width) {
+            width = w;
+            col = c;
+        }
+    }
+    if (width <= 0 || count + lowerBound(d) >= best)
+        return;
+
+    size_t mark = d.excluded.size();
+    bool isOutpost = col >= d.numCells + d.numSegs;
+    while (d.dlink[col] != col) {
+        if (isOutpost && d.len[col] < d.need[col - d.numCells - d.numSegs])
+            break;
+        int k = d.opt[d.dlink[col]];
+        choose(d, k);
+        search(d, count + 1, best);
+        unchoose(d, k);
+        hideOption(d, k, -1);
+        d.excluded.push_back(k);
+    }
+    while (d.excluded.size() > mark) {
+        unhideOption(d, d.excluded.back(), -1);
+        d.excluded.pop_back();
+    }
+}
@@ -0,0 +1,266 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <random>
+#include <cstring>
+#include <cstdlib>
+#include <cctype>
+using namespace std;
+
+// Random instance generator for problemA.cpp and the other engines. The output is a
+// whole input file (T, then R C and the rows of every case) and depends only on the
+// options, so a suite is reproduced from its command line.
+// Every case picks its size in [minRows, maxRows] x [minCols, maxCols], lays out walls
+// in one of three structures and turns some walls into outposts:
+//  LAYOUT_SCATTER   - every cell is a wall with probability walls;
+//  LAYOUT_ROOMS     - wall lines split the grid into rooms, with a door in every wall
+//                     between two rooms; walls is the chance of an extra wall inside;
+//  LAYOUT_CORRIDORS - a maze of one-cell corridors; walls is the chance that a wall
+//                     between corridors stays, so 1 is a perfect maze.
+// An outpost gets a digit between 0 and its number of '.' neighbours, so it can be
+// met locally; the case as a whole may still have no solution.
+// A symmetry other than SYM_NONE is imposed by giving every orbit of cells the value
+// of its first cell; SYM_ROT4 and SYM_FULL make the grid square.
+enum Layout { LAYOUT_SCATTER, LAYOUT_ROOMS, LAYOUT_CORRIDORS };
+enum Sym { SYM_NONE, SYM_MIRROR, SYM_ROT2, SYM_ROT4, SYM_FULL };
+
+struct Options {
+    unsigned long long seed = 1;
+    int cases = 10;
+    int minRows = 5, maxRows = 10;
+    int minCols = 5, maxCols = 10;
+    double walls = 0.2;
+    double outposts = 0.1;    // chance that a wall becomes an outpost
+    Layout layout = LAYOUT_SCATTER;
+    Sym symmetry = SYM_NONE;
+};
+
+Options opts;
+
+bool parseRange(const char* s, int& lo, int& hi);
+vector<string> makeCase(mt19937_64& rng);
+void scatter(vector<string>& g, mt19937_64& rng);
+void rooms(vector<string>& g, mt19937_64& rng);
+void corridors(vector<string>& g, mt19937_64& rng);
+void symmetrize(vector<string>& g);
+void addOutposts(vector<string>& g, mt19937_64& rng);
+bool chance(mt19937_64& rng, double p);
+int below(mt19937_64& rng, int n);
+
+int main(int argc, char** argv) {
+    ios::sync_with_stdio(false);
+
+    bool ok = true;
+    for (int i = 1; i < argc && ok; i++) {
+        const char* a = argv[i];
+        if (strncmp(a, "--seed=", 7) == 0 && isdigit((unsigned char)a[7]))
+            opts.seed = strtoull(a + 7, nullptr, 10);
+        else if (strncmp(a, "--cases=", 8) == 0 && isdigit((unsigned char)a[8]))
+            opts.cases = atoi(a + 8);
+        else if (strncmp(a, "--rows=", 7) == 0)
+            ok = parseRange(a + 7, opts.minRows, opts.maxRows);
+        else if (strncmp(a, "--cols=", 7) == 0)
+            ok = parseRange(a + 7, opts.minCols, opts.maxCols);
+        else if (strncmp(a, "--size=", 7) == 0) {
+            ok = parseRange(a + 7, opts.minRows, opts.maxRows);
+            opts.minCols = opts.minRows, opts.maxCols = opts.maxRows;
+        }
+        else if (strncmp(a, "--walls=", 8) == 0)
+            opts.walls = atof(a + 8);
+        else if (strncmp(a, "--outposts=", 11) == 0)
+            opts.outposts = atof(a + 11);
+        else if (strcmp(a, "--layout=scatter") == 0)
+            opts.layout = LAYOUT_SCATTER;
+        else if (strcmp(a, "--layout=rooms") == 0)
+            opts.layout = LAYOUT_ROOMS;
+        else if (strcmp(a, "--layout=corridors") == 0)
+            opts.layout = LAYOUT_CORRIDORS;
+        else if (strcmp(a, "--symmetry=none") == 0)
+            opts.symmetry = SYM_NONE;
+        else if (strcmp(a, "--symmetry=mirror") == 0)
+            opts.symmetry = SYM_MIRROR;
+        else if (strcmp(a, "--symmetry=rot2") == 0)
+            opts.symmetry = SYM_ROT2;
+        else if (strcmp(a, "--symmetry=rot4") == 0)
+            opts.symmetry = SYM_ROT4;
+        else if (strcmp(a, "--symmetry=full") == 0)
+            opts.symmetry = SYM_FULL;
+        else
+            ok = false;
+    }
+    if (!ok) {
+        cerr << "usage: " << argv[0] << " [--seed=N] [--cases=N] [--rows=A[-B]] [--cols=A[-B]]"
+             << " [--size=A[-B]] [--walls=P] [--outposts=P] [--layout=scatter|rooms|corridors]"
+             << " [--symmetry=none|mirror|rot2|rot4|full] > input\n";
+        return 1;
+    }
+
+    mt19937_64 rng(opts.seed);
+    cout << opts.cases << "\n";
+    for (int k = 0; k < opts.cases; k++) {
+        vector<string> g = makeCase(rng);
+        cout << g.size() << " " << g[0].size() << "\n";
+        for (const string& row : g)
+            cout << row << "\n";
+    }
+    return 0;
+}
+
+// "A" or "A-B", both at least 1.
+bool parseRange(const char* s, int& lo, int& hi) {
+    if (!isdigit((unsigned char)*s))
+        return false;
+    char* end;
+    lo = hi = strtol(s, &end, 10);
+    if (*end == '-')
+        hi = strtol(end + 1, &end, 10);
+    return *end == '\0' && lo >= 1 && hi >= lo;
+}
+
+vector<string> makeCase(mt19937_64& rng) {
+    int R = opts.minRows + below(rng, opts.maxRows - opts.minRows + 1);
+    int C = opts.minCols + below(rng, opts.maxCols - opts.minCols + 1);
+    if (opts.symmetry == SYM_ROT4 || opts.symmetry == SYM_FULL)
+        C = R;
+    vector<string> g(R, string(C, '.'));
+    if (opts.layout == LAYOUT_ROOMS)
+        rooms(g, rng);
+    else if (opts.layout == LAYOUT_CORRIDORS)
+        corridors(g, rng);
+    else
+        scatter(g, rng);
+    symmetrize(g);
+    addOutposts(g, rng);
+    return g;
+}
+
+void scatter(vector<string>& g, mt19937_64& rng) {
+    for (string& row : g)
+        for (char& ch : row)
+            if (chance(rng, opts.walls))
+                ch = '#';
+}
+
+// Rooms of 3 to 6 cells a side between wall lines; every stretch of wall line between
+// two crossings gets one door.
+void rooms(vector<string>& g, mt19937_64& rng) {
+    int R = g.size(), C = g[0].size();
+    vector<int> rowLines, colLines;
+    for (int r = 3 + below(rng, 4); r < R - 1; r += 4 + below(rng, 4))
+        rowLines.push_back(r);
+    for (int c = 3 + below(rng, 4); c < C - 1; c += 4 + below(rng, 4))
+        colLines.push_back(c);
+    for (int r : rowLines)
+        for (int c = 0; c < C; c++)
+            g[r][c] = '#';
+    for (int c : colLines)
+        for (int r = 0; r < R; r++)
+            g[r][c] = '#';
+
+    vector<int> rowCuts = rowLines, colCuts = colLines;
+    rowCuts.insert(rowCuts.begin(), -1), rowCuts.push_back(R);
+    colCuts.insert(colCuts.begin(), -1), colCuts.push_back(C);
+    for (int r : rowLines)
+        for (size_t k = 0; k + 1 < colCuts.size(); k++)
+            if (colCuts[k + 1] - colCuts[k] > 1)
+                g[r][colCuts[k] + 1 + below(rng, colCuts[k + 1] - colCuts[k] - 1)] = '.';
+    for (int c : colLines)
+        for (size_t k = 0; k + 1 < rowCuts.size(); k++)
+            if (rowCuts[k + 1] - rowCuts[k] > 1)
+                g[rowCuts[k] + 1 + below(rng, rowCuts[k + 1] - rowCuts[k] - 1)][c] = '.';
+
+    for (int r = 0; r < R; r++)
+        for (int c = 0; c < C; c++)
+            if (g[r][c] == '.' && chance(rng, opts.walls))
+                g[r][c] = '#';
+}
+
+// Depth-first maze on the cells with both coordinates odd; the walls it leaves between
+// corridors are then knocked out with probability 1 - walls.
+void corridors(vector<string>& g, mt19937_64& rng) {
+    int R = g.size(), C = g[0].size();
+    for (string& row : g)
+        fill(row.begin(), row.end(), '#');
+    if (R < 3 || C < 3) {
+        scatter(g, rng);
+        return;
+    }
+    const int dr[4] = { 0, 0, 2, -2 }, dc[4] = { 2, -2, 0, 0 };
+    vector<pair<int, int>> stack = { { 1, 1 } };
+    g[1][1] = '.';
+    while (!stack.empty()) {
+        int r = stack.back().first, c = stack.back().second;
+        int next[4], n = 0;
+        for (int d = 0; d < 4; d++) {
+            int nr = r + dr[d], nc = c + dc[d];
+            if (nr > 0 && nr < R - 1 && nc > 0 && nc < C - 1 && g[nr][nc] == '#')
+                next[n++] = d;
+        }
+        if (n == 0) {
+            stack.pop_back();
+            continue;
+        }
+        int d = next[below(rng, n)];
+        g[r + dr[d] / 2][c + dc[d] / 2] = '.';
+        g[r + dr[d]][c + dc[d]] = '.';
+        stack.push_back({ r + dr[d], c + dc[d] });
+    }
+    for (string& row : g)
+        for (char& ch : row)
+            if (ch == '#' && !chance(rng, opts.walls))
+                ch = '.';
+}
+
+// Every cell takes the value of the first cell of its orbit in row-major order.
+void symmetrize(vector<string>& g) {
+    if (opts.symmetry == SYM_NONE)
+        return;
+    int R = g.size(), C = g[0].size();
+    vector<string> src = g;
+    for (int r = 0; r < R; r++) {
+        for (int c = 0; c < C; c++) {
+            vector<pair<int, int>> orbit = { { r, c } };
+            if (opts.symmetry == SYM_MIRROR)
+                orbit.push_back({ r, C - 1 - c });
+            if (opts.symmetry != SYM_MIRROR)
+                orbit.push_back({ R - 1 - r, C - 1 - c });
+            if (opts.symmetry == SYM_ROT4 || opts.symmetry == SYM_FULL) {
+                orbit.push_back({ c, R - 1 - r });
+                orbit.push_back({ R - 1 - c, r });
+            }
+            if (opts.symmetry == SYM_FULL) {
+                orbit.push_back({ c, r });
+                orbit.push_back({ R - 1 - c, C - 1 - r });
+                orbit.push_back({ r, C - 1 - c });
+                orbit.push_back({ R - 1 - r, c });
+            }
+            pair<int, int> first = *min_element(orbit.begin(), orbit.end());
+            g[r][c] = src[first.first][first.second];
+        }
+    }
+}
+
+// Outpost digits are drawn per orbit of the symmetry, from the first cell of the orbit,
+// whose '.' neighbours match every other cell's.
+void addOutposts(vector<string>& g, mt19937_64& rng) {
+    int R = g.size(), C = g[0].size();
+    for (int r = 0; r < R; r++) {
+        for (int c = 0; c < C; c++) {
+            if (g[r][c] != '#' || !chance(rng, opts.outposts))
+                continue;
+            int free = (r > 0 && g[r - 1][c] == '.') + (r + 1 < R && g[r + 1][c] == '.')
+                + (c > 0 && g[r][c - 1] == '.') + (c + 1 < C && g[r][c + 1] == '.');
+            g[r][c] = '0' + below(rng, free + 1);
+        }
+    }
+    symmetrize(g);
+}
+
+bool chance(mt19937_64& rng, double p) {
+    return uniform_real_distribution<double>(0, 1)(rng) < p;
+}
+
+int below(mt19937_64& rng, int n) {
+    return uniform_int_distribution<int>(0, n - 1)(rng);
+}
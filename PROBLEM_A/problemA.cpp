@@ -1,11 +1,143 @@
 #include <iostream>
 #include <vector>
 #include <algorithm>
-#include <bitset>
 #include <climits>
+#include <cmath>
+#include <cstring>
+#include <cstdint>
+#include <cstdlib>
+#include <cctype>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <deque>
+#include <memory>
+#include <condition_variable>
+#include <chrono>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#define INPUT_MMAP
+#endif
 using namespace std;
 
-const int MAX_CAND = 256;
+// Segment capacities the solver is instantiated for; each test case runs on the
+// smallest one that fits its number of row plus column segments.
+const int CAPACITIES[] = { 64, 128, 256, 512, 1024, 2048, 4096 };
+const int MAX_SEG = 4096;
+
+// dfs depth, counted from the start of a task, down to which a busy search thread
+// hands its remaining siblings to idle ones.
+const int SPLIT_DEPTH = 8;
+
+// Most dfs nodes a search thread takes from the anytime budget at once; it looks at
+// the clock once per batch.
+const int BUDGET_CHECK_NODES = 1024;
+
+// Bytes Input asks stdin for at a time when it cannot map it.
+const size_t INPUT_BLOCK = 1 << 22;
+
+// How dfs picks what to branch on:
+//  BRANCH_ORDER - place or skip the next available candidate of the static candOrder;
+//  BRANCH_CELL  - take the uncovered cell with the fewest available coverers and try
+//                 each of them (all lie in that cell's row or column segment).
+enum Branching { BRANCH_ORDER, BRANCH_CELL };
+
+// How solveCase drives dfs:
+//  SEARCH_DEEPENING - one dfs per turret budget k, from the root lower bound upwards;
+//  SEARCH_BNB       - a single dfs seeded with a greedy solution that keeps tightening
+//                     the budget below the best count found so far.
+enum SearchMode { SEARCH_DEEPENING, SEARCH_BNB };
+
+// Where pruneDominated drops candidates another one does at least as well as:
+//  DOMINANCE_OFF    - nowhere;
+//  DOMINANCE_ROOT   - once, on the propagated root;
+//  DOMINANCE_SEARCH - on the root and again at every dfs node, as turrets light more
+//                     cells and exclusions empty more segments.
+enum Dominance { DOMINANCE_OFF, DOMINANCE_ROOT, DOMINANCE_SEARCH };
+
+// Instruction set of the mask kernels; SIMD_AUTO takes the widest the CPU supports.
+enum SimdLevel { SIMD_AUTO, SIMD_SCALAR, SIMD_SSE2, SIMD_AVX2, SIMD_AVX512 };
+
+struct Options {
+    Branching branching = BRANCH_CELL;
+    SearchMode search = SEARCH_BNB;
+    SimdLevel simd = SIMD_AUTO;
+    bool splitComponents = true; // solve independent parts of the grid separately
+    bool symmetry = true;     // skip branches a symmetry of the grid maps onto earlier ones
+    Dominance dominance = DOMINANCE_ROOT;
+    bool printNodes = false;  // report search nodes per case on stderr
+    bool printPlacement = false; // print the grid with the turrets after each answer
+    int ttMb = 64;            // transposition table size; 0 turns it off
+    int threads = 1;          // search threads per case; 0 uses every core
+    int jobs = 1;             // cases solved at once; above 1 reads the whole input first
+    int profileWidth = 12;    // narrow side up to which profileSolve is tried; 0 never
+    int profileMb = 256;      // memory cap of the profile maps
+    // Anytime mode: a case stops searching once either runs out, and reports the best
+    // placement found with a proven lower bound. 0 means no limit.
+    long long timeLimitMs = 0;
+    long long nodeLimit = 0;
+};
+
+Options opts;
+// Per search thread; parallelSearch adds the workers' counts to the caller's.
+thread_local long long nodeCount = 0;
+thread_local long long budgetLeft = 0; // nodes taken from the anytime budget, not yet run
+thread_local long long ttCuts = 0;     // nodes cut by a transposition table entry
+thread_local long long dominated = 0;  // candidates dropped by pruneDominated
+// Tasks this thread has handed to the pool; dfs compares it around a node to tell
+// whether the node's whole subtree was searched here.
+thread_local long long donations = 0;
+
+// Finer search counters, only kept when built with -DSEARCH_STATS; each case then
+// prints them as one JSON line on stderr. Otherwise STAT and STAT_TIMER expand to
+// nothing and the search does no extra work.
+struct SearchStats {
+    long long coverPrunes = 0;    // propagate: a cell left without a possible coverer
+    long long overflowPrunes = 0; // propagate: an outpost with more turrets than req
+    long long outpostPrunes = 0;  // propagate: an outpost short of free neighbours
+    long long boundPrunes = 0;    // dfs: budget reached, or lowerBound above it
+    int maxDepth = 0;             // deepest dfs level (from the task root in a parallel search)
+    int rounds = 0;               // iterative deepening searches
+    double caseMs = 0, searchMs = 0; // whole case, and runSearch plus profileSolve
+};
+thread_local SearchStats stats;
+
+#ifdef SEARCH_STATS
+#define STAT(x) (x)
+// Adds the time until the end of the enclosing scope to ms.
+struct StatTimer {
+    double& ms;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    ~StatTimer() { ms += chrono::duration<double, milli>(chrono::steady_clock::now() - start).count(); }
+};
+#define STAT_TIMER(ms) StatTimer statTimer{ ms }
+#else
+#define STAT(x) ((void)0)
+#define STAT_TIMER(ms) ((void)0)
+#endif
+
+// Fixed-width mask over segment ids, kept as raw 64-bit words so the SIMD kernels
+// can load it directly.
+template <size_t N>
+struct SegMask {
+    uint64_t w[N / 64];
+
+    void reset() { memset(w, 0, sizeof(w)); }
+    bool test(int i) const { return (w[i >> 6] >> (i & 63)) & 1; }
+    void set(int i) { w[i >> 6] |= uint64_t(1) << (i & 63); }
+    void reset(int i) { w[i >> 6] &= ~(uint64_t(1) << (i & 63)); }
+};
+
+// Fused coverage test: ORs the rows (one mask of crossed column segments per row
+// segment, words words each) of every row segment not set in lit, and reports whether
+// the result lies inside lit. That is the case iff every cell of an unlit row segment
+// has its column segment lit, i.e. every cell is covered.
+typedef bool (*CoverKernel)(const uint64_t* rows, int numRows, const uint64_t* lit, int words);
+CoverKernel coverKernel;
 
 struct Outpost {
     int r, c, req;
@@ -16,97 +148,1197 @@ struct Candidate {
     int r, c;
 };
 
-void readGrid(int R, int C, vector<string>& grid);
-vector<Candidate> getCandidates(int R, int C, const vector<string>& grid, vector<vector<int>>& candIndex);
-bool hasObstacle(int R, int C, const vector<string>& grid);
-void computeCoverage(int R, int C, const vector<string>& grid, const vector<Candidate>& candidates,vector<bitset<MAX_CAND>>& candCoverage, vector<bitset<MAX_CAND>>& candConflict, vector<vector<int>>& candIndex);
-vector<Outpost> getOutposts(int R, int C, const vector<string>& grid, const vector<vector<int>>& candIndex);
-void dfs(int pos, int count, bitset<MAX_CAND> currCoverage, bitset<MAX_CAND> forbidden, vector<int>& outCount,const vector<bitset<MAX_CAND>>& candCoverage, const vector<bitset<MAX_CAND>>& candConflict,const vector<Outpost>& outposts, const vector<vector<int>>& candToOutposts,bitset<MAX_CAND> fullCoverage, const vector<int>& candOrder, int& best, bool& solutionFound);
+// Broken-profile DP (profileSolve) over a grid at most MAX_PROFILE_WIDTH wide. The
+// profile holds, for every column, the state of its column segment just above the
+// frontier, and the state of the row segment left of it. A cell is dark while
+// neither of its segments has a turret; it has to be lit by whichever of the two
+// still gets one.
+const int MAX_PROFILE_WIDTH = 20; // 3 bits per column plus 3 for the row fit in 64
+const int PROFILE_GAVE_UP = -2;
+const uint64_t EMPTY_PROFILE = ~uint64_t(0); // no row state is 7, so no profile is all ones
+
+enum ColState {
+    COL_CLOSED,       // cell above is a wall, an outpost or outside the grid
+    COL_NEED,         // cell above is an outpost that needs a turret on this cell
+    COL_LIT,          // open segment without a turret, every cell of it lit by its row
+    COL_DARK,         // open segment without a turret and a dark cell: needs one below
+    COL_PENDING,      // like COL_LIT, except the cell in the current row, which is lit
+                      // iff the current row segment gets a turret
+    COL_TURRET_ABOVE, // turret on the cell just above
+    COL_TURRET,       // turret higher up in the segment
+    COL_BLOCKED       // cell above is an outpost that takes no more turrets: none here
+};
+
+enum RowState {
+    ROW_CLOSED,       // cell to the left is a wall or outside the grid
+    ROW_OUT0, ROW_OUT1, ROW_OUT2, // cell to the left is an outpost that still needs
+                      // that many turrets from its right and lower neighbours
+    ROW_OPEN,         // open segment without a turret
+    ROW_TURRET_LEFT,  // turret on the cell just to the left
+    ROW_TURRET        // turret further left in the segment
+};
+
+// Open-addressing map from profile to the fewest turrets that reach it.
+struct ProfileMap {
+    vector<uint64_t> keys;    // EMPTY_PROFILE marks a free slot
+    vector<int> cost;
+    vector<int> from;         // how the cheapest way got here: the position of its
+                              // profile in the previous map's used, times 2, plus 1
+                              // if the step put a turret on its cell; empty if the
+                              // map does not keep track
+    vector<int> used;         // occupied slots, in insertion order
+    size_t maxSlots = 0;
+
+    void init(size_t slots, size_t cap, bool track);
+    void clear();
+    bool relax(uint64_t key, int c, int f);
+};
+
+// Rows of a case where Input left them: row i is the C cells at data + i * stride.
+struct Grid {
+    const char* data = nullptr;
+    size_t stride = 0;
+
+    const char* operator[](int i) const { return data + i * stride; }
+};
+
+struct Case {
+    int R, C;
+    Grid grid;
+};
+
+// Reader of the whole input. A regular file on stdin is mapped privately and read in
+// place; anything else comes in blocks of INPUT_BLOCK bytes through buf, which drops
+// what lies before mark when it has to make room. Grids point at their rows in the
+// buffer: evenly spaced rows (one per line, whatever the line ending) are used as
+// they are, and other layouts are first moved together to stride C, which only ever
+// shifts bytes towards the start of the case. Positions inside the case being read
+// are kept relative to mark, so a refill that shifts the buffer does not upset them.
+struct Input {
+    char* data = nullptr;     // bytes [0, size) are loaded; pos is the cursor
+    size_t size = 0, pos = 0;
+    size_t mark = 0;          // start of the case being read
+    bool mapped = false, eof = false;
+    vector<char> buf;
+    vector<size_t> rowStart;  // rows of the case being read, relative to mark
+
+    void open();
+    void readAll();
+    bool refill();
+    bool token(size_t& start, size_t& len);
+    bool number(long long& v);
+    bool readCase(Case& cs);
+};
+
+// What solving a case, or one part of it, established. count is the fewest turrets
+// found (-1 if none) and lower a count no placement goes below. If optimal, the search
+// ran to the end: count is the minimum, or -1 means no placement exists. turrets is
+// the placement of count turrets; the profile DP only fills it in placement mode.
+struct Result {
+    int count = -1;
+    int lower = 0;
+    bool optimal = true;
+    vector<Candidate> turrets;
+};
+
+// Per-case allowance of the anytime mode, shared by every part of the case and every
+// search thread. nodes is what the threads have taken: each takes batches of at most
+// BUDGET_CHECK_NODES and its share of what the node limit leaves, and gives back what
+// it did not run when its search ends, so no case runs more nodes than the limit.
+// Once the time or the nodes run out, exhausted stays set and every search stops.
+struct Budget {
+    chrono::steady_clock::time_point deadline;
+    atomic<long long> nodes{0};
+    atomic<bool> exhausted{false};
+};
+
+struct CaseResult {
+    Result result;
+    long long nodes, cuts, dominated;
+    SearchStats stats;
+};
+
+// Maximal horizontal/vertical runs of '.' cells between walls, outposts and the border.
+// A turret sees exactly its row segment and its column segment, so a cell is covered
+// iff one of its two segments holds a turret, and two turrets conflict iff they share one.
+// Row segments get ids [0, numRow), column segments [numRow, numRow + numCol).
+struct Segments {
+    int numRow = 0, numCol = 0;
+    vector<int> rowSeg, colSeg;   // segment ids of each candidate
+    vector<vector<int>> cells;    // candidates lying in each segment, in grid order
+    vector<int> line, start;      // row (column) index and first column (row) of each segment
+    int maskWords = 0;            // words per segment mask of the chosen capacity
+    vector<uint64_t> rowCross;    // per row segment, the column segments it crosses
+};
+
+// A rotation or reflection of the grid that maps the cells of a part onto themselves
+// and every outpost next to them onto one with the same digit, as maps of candidate,
+// segment and outpost indices. A transposing one sends row segments to column ones.
+struct Symmetry {
+    vector<int> cand, seg, outpost;
+};
+
+template <size_t N>
+struct Worker;
+
+// Search node: turrets placed so far plus the candidates ruled out by branching
+// or propagation. A candidate is available iff it is not forbidden and neither
+// of its segments is occupied.
+// The search mutates one SearchState in place. Every placement and exclusion is
+// pushed on the trail (placed candidates as cand, forbidden ones as ~cand), and
+// undoTo rolls the state back to an earlier trail size on backtrack.
+template <size_t N>
+struct SearchState {
+    SegMask<N> occupied;      // segments holding a turret (= lit segments)
+    vector<char> forbidden;   // per candidate
+    vector<int> outCount;     // turrets adjacent to each outpost
+    int count = 0;            // turrets placed
+    vector<int> trail;
+
+    // Zobrist key of what the rest of the search depends on: the lit segments, each
+    // outpost's count and the forbidden candidates that are still open (both segments
+    // free). Turrets on the crossings of the same rows and columns give the same key.
+    uint64_t hash = 0;
+    vector<uint64_t> zSeg, zExcluded; // per segment, per candidate
+    vector<uint64_t> zOutpost;        // per outpost and count 0..4, at 5 * opIdx + count
+
+    // Available candidates per segment, kept up to date by placeTurret, forbidCandidate
+    // and undoTo. A cell's possible coverers are those of its two segments.
+    vector<int> segAvail;
+    // Segments whose count dropped to 2 or less since the last propagate; only their
+    // cells can have run out of coverers or be down to a single one.
+    vector<int> pending;
+    vector<char> inPending;
+
+    // Scratch space sized once by initState, so the search itself never allocates.
+    vector<int> packed;       // cells packed by lowerBound
+    // Components of the uncovered-cell graph, found by labelComponents: the segments
+    // of component k are compQueue[compStart[k] .. compStart[k + 1]).
+    vector<int> segComp;      // per segment, -1 if it has no uncovered cell
+    vector<int> segDeg;       // per segment, its uncovered cells
+    vector<int> compQueue, compStart, compPacked;
+    vector<int> mate;         // per segment, matched partner in segmentCoverBound
+    vector<int> seen;         // per segment, last augmenting search that visited it
+    int seenStamp = 0;
+    vector<int> degBuf;
+    vector<vector<int>> branchBuf; // branch set of each dfs depth
+
+    // Symmetries of the part (none but the identity is listed) and, as bit k for
+    // symmetries[k], those that may still map the state onto itself. dfs narrows the
+    // bits down to the ones that do before expanding a node; children start from them.
+    vector<Symmetry> symmetries;
+    uint8_t symmetric = 0;
+    vector<int> symMark;      // per candidate, last donateSiblings call that excluded it
+    int symStamp = 0;
+
+    Worker<N>* worker = nullptr;   // owning thread of a parallel search, if any
+    uint32_t ttGen = 0;            // transposition table generation of the case
+};
+
+// Turret budget shared by the whole search: dfs only looks for solutions with at
+// most limit turrets. Finding one records it and lowers limit below it. With several
+// threads every one of them prunes against the same limit; updates to found and
+// limit go through recordSolution.
+struct Bound {
+    atomic<int> limit{0};
+    int lowest = 0;           // root lower bound; a solution of this size ends the search
+    atomic<int> found{-1};    // smallest turret count found so far
+    atomic<bool> stop{false};
+    mutex lock;
+    vector<int> best;         // turrets of the solution behind found, as candidates
+    Budget* budget = nullptr; // anytime allowance, if any
+};
+
+// A subtree handed between threads: the trail entries that lead to it from the
+// propagated root (placements as cand, exclusions as ~cand). The empty task is the
+// root itself.
+typedef vector<int> Task;
+
+template <size_t N>
+struct WorkPool;
+
+// One search thread: its own copy of the root state and a deque of tasks. The owner
+// pushes and pops at the back; other threads steal from the front, where the older
+// and usually larger subtrees are.
+template <size_t N>
+struct Worker {
+    int id;
+    WorkPool<N>* pool;
+    SearchState<N> st;
+    size_t rootMark;          // trail size of the root; tasks are replayed from there
+    deque<Task> tasks;
+    mutex lock;
+    long long nodes = 0, cuts = 0, dominated = 0;
+    SearchStats stats;
+};
+
+template <size_t N>
+struct WorkPool {
+    vector<unique_ptr<Worker<N>>> workers;
+    atomic<int> busy{0};      // threads holding a task, or trying to take one
+    atomic<int> queued{0};    // tasks waiting in the deques
 
-int main() {
+    bool hungry() const;
+    void push(Worker<N>& w, Task&& task);
+    bool take(Worker<N>& w, Task& task);
+};
+
+// Fixed-size table of search results keyed by SearchState::hash. An entry records
+// that no solution below the state has fewer than bound turrets, which is what a dfs
+// that returns without a solution proves for limit + 1. Lookups cut the node when
+// the stored bound is above the current budget.
+// Entries come in buckets of four (one cache line). A new result replaces, in order,
+// the entry of the same state, an entry of another case, or the entry whose subtree
+// took the least work to search. Every case gets its own generation from newCase,
+// so cases searched one after another or at the same time never see each other's
+// entries and the table is never cleared.
+// Threads share the table without locks: data packs the generation (bits 0-31), the
+// bound (32-55; it is at most E + 1 and E stays below 2^22 with MAX_SEG segments)
+// and the work, the bit length of the node count that proved it (56-63). check is
+// key ^ data, so a slot torn by two concurrent writers fails the key test instead
+// of answering with another state's bound.
+// The table is only allocated, and zeroed, when the first search starts, so inputs
+// that the DP and the root propagation settle never pay for it.
+struct TTEntry {
+    atomic<uint64_t> check{0};
+    atomic<uint64_t> data{0};
+};
+
+struct TranspositionTable {
+    unique_ptr<TTEntry[]> entries;
+    size_t numEntries = 0;
+    size_t bucketMask = 0;
+    atomic<uint32_t> lastGen{0};
+    once_flag allocated;
+
+    void allocate();
+    void resize(int megabytes);
+    uint32_t newCase();
+    bool enabled() const { return numEntries != 0; }
+    int probe(uint64_t key, uint32_t gen) const;
+    void store(uint64_t key, uint32_t gen, int bound, long long nodes);
+};
+
+TranspositionTable tt;
+
+vector<Candidate> getCandidates(int R, int C, const Grid& grid, vector<vector<int>>& candIndex);
+bool hasObstacle(int R, int C, const Grid& grid);
+Segments getSegments(int R, int C, const Grid& grid, const vector<vector<int>>& candIndex);
+vector<Outpost> getOutposts(int R, int C, const Grid& grid, const vector<vector<int>>& candIndex);
+template <size_t N>
+bool coversAll(const SegMask<N>& lit, const Segments& segs);
+void buildCrossMasks(Segments& segs, int words);
+bool coverScalar(const uint64_t* rows, int numRows, const uint64_t* lit, int words);
+bool coverSse2(const uint64_t* rows, int numRows, const uint64_t* lit, int words);
+bool coverAvx2(const uint64_t* rows, int numRows, const uint64_t* lit, int words);
+bool coverAvx512(const uint64_t* rows, int numRows, const uint64_t* lit, int words);
+bool selectKernels(SimdLevel level);
+int crossing(const Segments& segs, int rs, int cs);
+// The cell where row segment rs meets column segment cs, or -1 if they don't cross.
+int crossing(const Segments& segs, int rs, int cs) {
+    int r = segs.line[rs], c = segs.line[cs];
+    int offset = c - segs.start[rs];
+    if (offset < 0 || offset >= (int)segs.cells[rs].size())
+        return -1;
+    if (r < segs.start[cs] || r >= segs.start[cs] + (int)segs.cells[cs].size())
+        return -1;
+    return segs.cells[rs][offset];
+}
+
+template <size_t N>
+bool isSolution(const SearchState<N>& st, const Segments& segs, const vector<Outpost>& outposts);
+template <size_t N>
+void initState(SearchState<N>& st, const Segments& segs, const vector<Outpost>& outposts);
+template <size_t N>
+bool isAvailable(const SearchState<N>& st, const Segments& segs, int cand);
+template <size_t N>
+bool isOpenExclusion(const SearchState<N>& st, const Segments& segs, int cand);
+template <size_t N>
+void placeTurret(SearchState<N>& st, const Segments& segs, const vector<vector<int>>& candToOutposts, int cand);
+template <size_t N>
+void forbidCandidate(SearchState<N>& st, const Segments& segs, int cand);
+template <size_t N>
+void markUnavailable(SearchState<N>& st, const Segments& segs, int cand);
+template <size_t N>
+void markAvailable(SearchState<N>& st, const Segments& segs, int cand);
+template <size_t N>
+void clearPending(SearchState<N>& st);
+template <size_t N>
+void undoTo(SearchState<N>& st, const Segments& segs, const vector<vector<int>>& candToOutposts, size_t mark);
+template <size_t N>
+bool propagate(SearchState<N>& st, const Segments& segs, const vector<Outpost>& outposts, const vector<vector<int>>& candToOutposts);
+template <size_t N>
+int lowerBound(SearchState<N>& st, const Segments& segs);
+template <size_t N>
+int labelComponents(SearchState<N>& st, const Segments& segs);
+template <size_t N>
+int segmentCoverBound(SearchState<N>& st, const Segments& segs, int k);
+template <size_t N>
+bool augment(SearchState<N>& st, const Segments& segs, int rs);
+int sideBound(const vector<int>& deg, int n, int deficiency);
+template <size_t N>
+int greedyUpperBound(SearchState<N>& st, const Segments& segs, const vector<Outpost>& outposts, const vector<vector<int>>& candToOutposts, vector<int>& placement);
+template <size_t N>
+void getBranchSet(SearchState<N>& st, const Segments& segs, const vector<Outpost>& outposts, vector<int>& branch);
+template <size_t N>
+void dfs(int pos, int depth, SearchState<N>& st, const Segments& segs, const vector<Outpost>& outposts, const vector<vector<int>>& candToOutposts, const vector<int>& candOrder, Bound& bound);
+template <size_t N>
+void expandNode(int pos, int depth, SearchState<N>& st, const Segments& segs, const vector<Outpost>& outposts, const vector<vector<int>>& candToOutposts, const vector<int>& candOrder, Bound& bound);
+template <size_t N>
+Result solveCase(const Segments& segs, const vector<Outpost>& outposts, Budget* budget);
+Result solve(int R, int C, const Grid& grid);
+Result solveSegments(Segments& segs, const vector<Outpost>& outposts, Budget* budget);
+int splitComponents(const Segments& segs, const vector<Outpost>& outposts, vector<Segments>& compSegs, vector<vector<Outpost>>& compOutposts);
+vector<Symmetry> findSymmetries(const Segments& segs, const vector<Outpost>& outposts);
+template <size_t N>
+int pruneDominated(SearchState<N>& st, const Segments& segs, const vector<vector<int>>& candToOutposts);
+int otherSegment(const Segments& segs, int cand, int s);
+template <size_t N>
+uint8_t stateSymmetries(const SearchState<N>& st, const Segments& segs, uint8_t mask);
+template <size_t N>
+void forbidImages(SearchState<N>& st, const Segments& segs, int cand);
+uint64_t splitmix64(uint64_t x);
+void recordSolution(Bound& bound, int count, const vector<int>& trail);
+bool outOfBudget(Budget& budget);
+void returnBudget(Budget& budget);
+bool anytimeMode();
+CaseResult solveTimed(const Case& cs);
+void printResult(const Case& cs, const CaseResult& res);
+void printStats(const CaseResult& res);
+void addStats(SearchStats& into, const SearchStats& from);
+void runBatch(const vector<Case>& cases);
+bool profileResult(int R, int C, const Grid& grid, Budget* budget, Result& dp);
+int profileSolve(int R, int C, const Grid& grid, vector<Candidate>* placement, Budget* budget);
+bool profileStep(const vector<string>& g, const vector<vector<int>>& runStart, int W, int s,
+    ProfileMap& cur, ProfileMap& next);
+int profileAt(uint64_t key, int j);
+uint64_t withProfile(uint64_t key, int j, int state);
+bool closeRow(uint64_t& key, int W, int j, int runStart);
+template <size_t N>
+void runSearch(SearchState<N>& root, const Segments& segs, const vector<Outpost>& outposts, const vector<vector<int>>& candToOutposts, const vector<int>& candOrder, Bound& bound);
+template <size_t N>
+void parallelSearch(const SearchState<N>& root, const Segments& segs, const vector<Outpost>& outposts, const vector<vector<int>>& candToOutposts, const vector<int>& candOrder, Bound& bound);
+template <size_t N>
+void runWorker(Worker<N>& w, const Segments& segs, const vector<Outpost>& outposts, const vector<vector<int>>& candToOutposts, const vector<int>& candOrder, Bound& bound);
+template <size_t N>
+void donateSiblings(SearchState<N>& st, const Segments& segs, const vector<int>& branch, size_t first);
+
+int main(int argc, char** argv) {
     ios::sync_with_stdio(false);
     cin.tie(nullptr);
 
-    int T;
-    cin >> T;
-    while (T--) {
-        int R, C;
-        cin >> R >> C;
-        vector<string> grid(R);
-        readGrid(R, C, grid);
-
-        // Build candidate list for turret placements (cells with '.')
-        vector<vector<int>> candIndex(R, vector<int>(C, -1));
-        vector<Candidate> candidates = getCandidates(R, C, grid, candIndex);
-        int E = candidates.size();
-
-        // If grid has no obstacles (i.e. all '.'), answer is max(R, C)
-        if (!hasObstacle(R, C, grid)) {
-            cout << max(R, C) << "\n";
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--branch=order") == 0)
+            opts.branching = BRANCH_ORDER;
+        else if (strcmp(argv[i], "--branch=cell") == 0)
+            opts.branching = BRANCH_CELL;
+        else if (strcmp(argv[i], "--search=deepening") == 0)
+            opts.search = SEARCH_DEEPENING;
+        else if (strcmp(argv[i], "--search=bnb") == 0)
+            opts.search = SEARCH_BNB;
+        else if (strcmp(argv[i], "--simd=scalar") == 0)
+            opts.simd = SIMD_SCALAR;
+        else if (strcmp(argv[i], "--simd=sse2") == 0)
+            opts.simd = SIMD_SSE2;
+        else if (strcmp(argv[i], "--simd=avx2") == 0)
+            opts.simd = SIMD_AVX2;
+        else if (strcmp(argv[i], "--simd=avx512") == 0)
+            opts.simd = SIMD_AVX512;
+        else if (strcmp(argv[i], "--no-split") == 0)
+            opts.splitComponents = false;
+        else if (strcmp(argv[i], "--dominance=off") == 0)
+            opts.dominance = DOMINANCE_OFF;
+        else if (strcmp(argv[i], "--dominance=root") == 0)
+            opts.dominance = DOMINANCE_ROOT;
+        else if (strcmp(argv[i], "--dominance=search") == 0)
+            opts.dominance = DOMINANCE_SEARCH;
+        else if (strcmp(argv[i], "--no-symmetry") == 0)
+            opts.symmetry = false;
+        else if (strcmp(argv[i], "--nodes") == 0)
+            opts.printNodes = true;
+        else if (strcmp(argv[i], "--placement") == 0)
+            opts.printPlacement = true;
+        else if (strncmp(argv[i], "--tt-mb=", 8) == 0 && isdigit((unsigned char)argv[i][8]))
+            opts.ttMb = atoi(argv[i] + 8);
+        else if (strncmp(argv[i], "--threads=", 10) == 0 && isdigit((unsigned char)argv[i][10]))
+            opts.threads = atoi(argv[i] + 10);
+        else if (strncmp(argv[i], "--jobs=", 7) == 0 && isdigit((unsigned char)argv[i][7]))
+            opts.jobs = atoi(argv[i] + 7);
+        else if (strncmp(argv[i], "--profile-width=", 16) == 0 && isdigit((unsigned char)argv[i][16]))
+            opts.profileWidth = min(atoi(argv[i] + 16), MAX_PROFILE_WIDTH);
+        else if (strncmp(argv[i], "--profile-mb=", 13) == 0 && isdigit((unsigned char)argv[i][13]))
+            opts.profileMb = atoi(argv[i] + 13);
+        else if (strncmp(argv[i], "--time-limit=", 13) == 0 && isdigit((unsigned char)argv[i][13]))
+            opts.timeLimitMs = atoll(argv[i] + 13);
+        else if (strncmp(argv[i], "--node-limit=", 13) == 0 && isdigit((unsigned char)argv[i][13]))
+            opts.nodeLimit = atoll(argv[i] + 13);
+        else {
+            cerr << "usage: " << argv[0] << " [--branch=order|cell] [--search=deepening|bnb]"
+                 << " [--simd=scalar|sse2|avx2|avx512] [--no-split] [--no-symmetry]"
+                 << " [--dominance=off|root|search] [--tt-mb=N] [--threads=N]"
+                 << " [--jobs=N] [--profile-width=N] [--profile-mb=N] [--time-limit=MS]"
+                 << " [--node-limit=N] [--nodes] [--placement] < input\n";
+            return 1;
+        }
+    }
+    if (opts.threads == 0)
+        opts.threads = max(1u, thread::hardware_concurrency());
+    if (opts.jobs == 0)
+        opts.jobs = max(1u, thread::hardware_concurrency());
+    if (!selectKernels(opts.simd)) {
+        cerr << "the requested --simd level is not supported by this CPU\n";
+        return 1;
+    }
+
+    Input in;
+    in.open();
+    // Batches keep every case until the end, so the buffer must not move under them.
+    if (opts.jobs > 1)
+        in.readAll();
+    long long T = 0;
+    in.number(T);
+    if (opts.jobs > 1) {
+        vector<Case> cases(T);
+        for (Case& cs : cases)
+            if (!in.readCase(cs)) {
+                cerr << "input ends before case " << &cs - cases.data() + 1 << "\n";
+                return 1;
+            }
+        runBatch(cases);
+        return 0;
+    }
+    for (long long k = 1; k <= T; k++) {
+        Case cs;
+        if (!in.readCase(cs)) {
+            cerr << "input ends before case " << k << "\n";
+            return 1;
+        }
+        printResult(cs, solveTimed(cs));
+    }
+    return 0;
+}
+
+// Solves one case and collects the search counters of the calling thread.
+CaseResult solveTimed(const Case& cs) {
+    nodeCount = 0;
+    ttCuts = 0;
+    dominated = 0;
+    stats = SearchStats();
+    CaseResult res;
+    {
+        STAT_TIMER(stats.caseMs);
+        res.result = solve(cs.R, cs.C, cs.grid);
+    }
+    res.nodes = nodeCount;
+    res.cuts = ttCuts;
+    res.dominated = dominated;
+    res.stats = stats;
+    return res;
+}
+
+// In anytime mode the answer line says whether the count is optimal, or else gives
+// the proven lower bound ("unknown" stands for the count when nothing was found).
+// Otherwise a case that could not be searched (too many segments) prints "unknown".
+// In anytime and placement mode the grid follows with the placement's turrets as 'T'.
+void printResult(const Case& cs, const CaseResult& res) {
+    if (opts.printNodes)
+        cerr << "nodes: " << res.nodes << ", tt cuts: " << res.cuts << ", dominated: " << res.dominated << "\n";
+#ifdef SEARCH_STATS
+    printStats(res);
+#endif
+    const Result& r = res.result;
+    if (r.count == -1 && r.optimal) {
+        cout << "noxus will rise!" << "\n";
+        return;
+    }
+    if (r.count == -1)
+        cout << "unknown";
+    else
+        cout << r.count;
+    if (!anytimeMode())
+        cout << "\n";
+    else if (r.optimal)
+        cout << " optimal" << "\n";
+    else
+        cout << " not optimal, lower bound " << r.lower << "\n";
+    if (r.count == -1 || !(anytimeMode() || opts.printPlacement))
+        return;
+    static string rows;
+    rows.clear();
+    for (int i = 0; i < cs.R; i++) {
+        rows.append(cs.grid[i], cs.C);
+        rows += '\n';
+    }
+    for (const Candidate& t : r.turrets)
+        rows[t.r * (cs.C + 1) + t.c] = 'T';
+    cout << rows;
+}
+
+// One JSON line on stderr per case, numbered in input order. precompute_ms is the
+// part of the case spent outside the search: segments, outposts, components and each
+// part's root propagation, bounds and incumbent.
+void printStats(const CaseResult& res) {
+    static int caseNo = 0;
+    const SearchStats& s = res.stats;
+    cerr << "{\"case\": " << ++caseNo << ", \"nodes\": " << res.nodes
+        << ", \"tt_cuts\": " << res.cuts << ", \"dominated\": " << res.dominated
+        << ", \"prunes\": {\"coverage\": " << s.coverPrunes << ", \"overflow\": " << s.overflowPrunes
+        << ", \"outpost\": " << s.outpostPrunes << ", \"bound\": " << s.boundPrunes << "}"
+        << ", \"max_depth\": " << s.maxDepth << ", \"rounds\": " << s.rounds
+        << ", \"precompute_ms\": " << s.caseMs - s.searchMs << ", \"search_ms\": " << s.searchMs << "}\n";
+}
+
+// Solves the cases on opts.jobs threads. Cases are handed out by decreasing number of
+// '.' cells, so the hard ones start first instead of queueing behind easy ones; the
+// answers go through a reorder buffer and are printed in input order, each one as
+// soon as it and every case before it are done.
+void runBatch(const vector<Case>& cases) {
+    int T = cases.size();
+    vector<int> size(T, 0);
+    for (int k = 0; k < T; k++)
+        for (int i = 0; i < cases[k].R; i++)
+            size[k] += count(cases[k].grid[i], cases[k].grid[i] + cases[k].C, '.');
+    vector<int> order(T);
+    for (int k = 0; k < T; k++)
+        order[k] = k;
+    stable_sort(order.begin(), order.end(), [&](int a, int b) {
+        return size[a] > size[b];
+        });
+
+    vector<CaseResult> results(T);
+    vector<char> done(T, 0);
+    mutex lock;
+    condition_variable ready;
+    atomic<int> next{0};
+    vector<thread> jobs;
+    for (int j = 0; j < min(opts.jobs, T); j++)
+        jobs.emplace_back([&]() {
+            for (int k = next++; k < T; k = next++) {
+                CaseResult res = solveTimed(cases[order[k]]);
+                lock_guard<mutex> guard(lock);
+                results[order[k]] = res;
+                done[order[k]] = 1;
+                ready.notify_one();
+            }
+            });
+
+    for (int k = 0; k < T; k++) {
+        unique_lock<mutex> guard(lock);
+        if (!done[k]) {
+            // Let what is known so far out before blocking on case k.
+            cout.flush();
+            ready.wait(guard, [&]() { return done[k] != 0; });
+        }
+        guard.unlock();
+        printResult(cases[k], results[k]);
+    }
+    for (thread& t : jobs)
+        t.join();
+}
+
+// Solves one case; its count is -1 with optimal set if no valid placement exists.
+Result solve(int R, int C, const Grid& grid) {
+    // If grid has no obstacles (i.e. all '.'), one turret per row (or column) of the
+    // shorter side covers everything, and fewer leaves a free row/column crossing.
+    if (!hasObstacle(R, C, grid)) {
+        Result open;
+        open.count = open.lower = min(R, C);
+        for (int i = 0; i < min(R, C); i++)
+            open.turrets.push_back({ i, i });
+        return open;
+    }
+
+    Budget budget;
+    if (opts.timeLimitMs > 0)
+        budget.deadline = chrono::steady_clock::now() + chrono::milliseconds(opts.timeLimitMs);
+    Budget* allowance = anytimeMode() ? &budget : nullptr;
+
+    // Narrow grids go to the profile DP, which is linear in the long side; the search
+    // takes over if the profiles outgrow their memory cap.
+    bool narrow = min(R, C) <= opts.profileWidth;
+    Result dp;
+    if (narrow && !anytimeMode() && profileResult(R, C, grid, nullptr, dp))
+        return dp;
+
+    // Build candidate list for turret placements (cells with '.')
+    vector<vector<int>> candIndex(R, vector<int>(C, -1));
+    vector<Candidate> candidates = getCandidates(R, C, grid, candIndex);
+
+    // Label every candidate with its row and column segment.
+    Segments segs = getSegments(R, C, grid, candIndex);
+
+    // The anytime mode prefers the search, which has a placement and a bound whenever
+    // the budget runs out, and only turns to the DP, up to the deadline, for grids
+    // with more segments than the search takes.
+    if (narrow && anytimeMode() && segs.numRow + segs.numCol > MAX_SEG && profileResult(R, C, grid, allowance, dp))
+        return dp;
+
+    // Process outposts (cells with digits) and record their adjacent candidate indices.
+    vector<Outpost> outposts = getOutposts(R, C, grid, candIndex);
+
+    if (!opts.splitComponents)
+        return solveSegments(segs, outposts, allowance);
+
+    // Parts of the grid that share no segment and no outpost are independent: the
+    // answer is the sum of theirs, and one impossible part makes the whole grid so.
+    vector<Segments> compSegs;
+    vector<vector<Outpost>> compOutposts;
+    int numComp = splitComponents(segs, outposts, compSegs, compOutposts);
+    if (numComp == -1)
+        return Result();
+    // Smallest parts first, so an impossible one is usually found cheaply.
+    vector<int> compOrder(numComp);
+    for (int k = 0; k < numComp; k++)
+        compOrder[k] = k;
+    sort(compOrder.begin(), compOrder.end(), [&](int a, int b) {
+        return compSegs[a].rowSeg.size() < compSegs[b].rowSeg.size();
+        });
+    // Once the budget is spent, the remaining parts still get their greedy placement
+    // and root lower bound.
+    Result total;
+    total.count = 0;
+    for (int k : compOrder) {
+        Result part = solveSegments(compSegs[k], compOutposts[k], allowance);
+        if (part.count == -1 && part.optimal)
+            return part;
+        total.count = total.count == -1 || part.count == -1 ? -1 : total.count + part.count;
+        total.lower += part.lower;
+        total.optimal = total.optimal && part.optimal;
+        total.turrets.insert(total.turrets.end(), part.turrets.begin(), part.turrets.end());
+    }
+    return total;
+}
+
+// Runs the search on one set of segments with the smallest mask capacity that fits.
+// Past the largest one nothing is searched: the part comes back without a count and
+// not optimal, so it is reported as unknown rather than as having no placement.
+Result solveSegments(Segments& segs, const vector<Outpost>& outposts, Budget* budget) {
+    int S = segs.numRow + segs.numCol;
+    for (int capacity : CAPACITIES) {
+        if (S <= capacity) {
+            buildCrossMasks(segs, capacity / 64);
+            break;
+        }
+    }
+    if (S <= CAPACITIES[0]) return solveCase<64>(segs, outposts, budget);
+    if (S <= CAPACITIES[1]) return solveCase<128>(segs, outposts, budget);
+    if (S <= CAPACITIES[2]) return solveCase<256>(segs, outposts, budget);
+    if (S <= CAPACITIES[3]) return solveCase<512>(segs, outposts, budget);
+    if (S <= CAPACITIES[4]) return solveCase<1024>(segs, outposts, budget);
+    if (S <= CAPACITIES[5]) return solveCase<2048>(segs, outposts, budget);
+    if (S <= CAPACITIES[6]) return solveCase<4096>(segs, outposts, budget);
+
+    cerr << "grid has " << S << " segments, more than the supported " << MAX_SEG << "\n";
+    Result tooBig;
+    tooBig.optimal = false;
+    return tooBig;
+}
+
+// Groups candidates into connected parts, two being linked when they share a segment
+// or neighbour the same outpost, and rebuilds the segments and outposts of each part
+// with ids local to it. Outposts without neighbouring cells belong to no part.
+// Returns the number of parts, or -1 if such an outpost still asks for turrets.
+int splitComponents(const Segments& segs, const vector<Outpost>& outposts,
+    vector<Segments>& compSegs, vector<vector<Outpost>>& compOutposts) {
+    int E = segs.rowSeg.size();
+    int S = segs.numRow + segs.numCol;
+    vector<int> parent(E);
+    for (int i = 0; i < E; i++)
+        parent[i] = i;
+    auto find = [&](int x) {
+        while (parent[x] != x)
+            x = parent[x] = parent[parent[x]];
+        return x;
+    };
+    auto unite = [&](int a, int b) { parent[find(a)] = find(b); };
+
+    for (int s = 0; s < S; s++)
+        for (size_t k = 1; k < segs.cells[s].size(); k++)
+            unite(segs.cells[s][0], segs.cells[s][k]);
+    for (const Outpost& op : outposts) {
+        if (op.adj.empty() && op.req > 0)
+            return -1;
+        for (size_t k = 1; k < op.adj.size(); k++)
+            unite(op.adj[0], op.adj[k]);
+    }
+
+    vector<int> compOf(E, -1), localIdx(E);
+    int numComp = 0;
+    for (int i = 0; i < E; i++) {
+        int root = find(i);
+        if (compOf[root] == -1)
+            compOf[root] = numComp++;
+        compOf[i] = compOf[root];
+    }
+    compSegs.assign(numComp, Segments());
+    compOutposts.assign(numComp, vector<Outpost>());
+    for (int i = 0; i < E; i++) {
+        vector<int>& rowSeg = compSegs[compOf[i]].rowSeg;
+        localIdx[i] = rowSeg.size();
+        rowSeg.push_back(-1);
+    }
+
+    // Segments keep their relative order; row segments are renumbered before column
+    // ones so each part keeps the [rows | columns] id layout.
+    vector<int> localSeg(S);
+    for (int s = 0; s < segs.numRow; s++)
+        localSeg[s] = compSegs[compOf[segs.cells[s][0]]].numRow++;
+    for (int s = segs.numRow; s < S; s++)
+        localSeg[s] = compSegs[compOf[segs.cells[s][0]]].numCol++;
+    for (int k = 0; k < numComp; k++) {
+        Segments& part = compSegs[k];
+        part.colSeg.assign(part.rowSeg.size(), -1);
+        part.cells.assign(part.numRow + part.numCol, vector<int>());
+        part.line.assign(part.numRow + part.numCol, -1);
+        part.start.assign(part.numRow + part.numCol, -1);
+    }
+    for (int s = 0; s < S; s++) {
+        Segments& part = compSegs[compOf[segs.cells[s][0]]];
+        int id = s < segs.numRow ? localSeg[s] : part.numRow + localSeg[s];
+        part.line[id] = segs.line[s];
+        part.start[id] = segs.start[s];
+        for (int cand : segs.cells[s]) {
+            part.cells[id].push_back(localIdx[cand]);
+            if (s < segs.numRow)
+                part.rowSeg[localIdx[cand]] = id;
+            else
+                part.colSeg[localIdx[cand]] = id;
+        }
+    }
+
+    for (const Outpost& op : outposts) {
+        if (op.adj.empty())
             continue;
+        Outpost local = { op.r, op.c, op.req, {} };
+        for (int cand : op.adj)
+            local.adj.push_back(localIdx[cand]);
+        compOutposts[compOf[op.adj[0]]].push_back(local);
+    }
+    return numComp;
+}
+
+// Lists the rotations and reflections that map the part onto itself, identity left
+// out. They act on the bounding box of its cells; the four that swap rows and
+// columns need a square box.
+vector<Symmetry> findSymmetries(const Segments& segs, const vector<Outpost>& outposts) {
+    int E = segs.rowSeg.size();
+    vector<Symmetry> found;
+    if (E == 0)
+        return found;
+    vector<int> row(E), col(E);
+    int top = INT_MAX, left = INT_MAX, bottom = INT_MIN, right = INT_MIN;
+    for (int i = 0; i < E; i++) {
+        row[i] = segs.line[segs.rowSeg[i]];
+        col[i] = segs.line[segs.colSeg[i]];
+        top = min(top, row[i]);
+        bottom = max(bottom, row[i]);
+        left = min(left, col[i]);
+        right = max(right, col[i]);
+    }
+    int H = bottom - top + 1, W = right - left + 1;
+
+    // Cells and outposts by position, for lookups of the mapped ones. Outposts may sit
+    // one step outside the box.
+    auto key = [&](int r, int c) { return (long long)(r - top + 1) * (W + 2) + (c - left + 1); };
+    vector<pair<long long, int>> cellAt(E), outpostAt;
+    for (int i = 0; i < E; i++)
+        cellAt[i] = make_pair(key(row[i], col[i]), i);
+    for (int k = 0; k < (int)outposts.size(); k++)
+        outpostAt.push_back(make_pair(key(outposts[k].r, outposts[k].c), k));
+    sort(cellAt.begin(), cellAt.end());
+    sort(outpostAt.begin(), outpostAt.end());
+    auto lookup = [](const vector<pair<long long, int>>& at, long long k) {
+        auto it = lower_bound(at.begin(), at.end(), make_pair(k, INT_MIN));
+        return it != at.end() && it->first == k ? it->second : -1;
+    };
+
+    // Transform t: bit 2 swaps rows and columns, then bit 0 flips rows and bit 1 columns.
+    for (int t = 1; t < 8; t++) {
+        bool swapped = t & 4;
+        if (swapped && H != W)
+            continue;
+        auto image = [&](int r, int c, int& r2, int& c2) {
+            int x = r - top, y = c - left;
+            if (swapped)
+                swap(x, y);
+            if (t & 1)
+                x = H - 1 - x;
+            if (t & 2)
+                y = W - 1 - y;
+            r2 = x + top;
+            c2 = y + left;
+        };
+        Symmetry sym;
+        sym.cand.resize(E);
+        sym.seg.resize(segs.numRow + segs.numCol);
+        sym.outpost.resize(outposts.size());
+        bool ok = true;
+        for (int i = 0; i < E && ok; i++) {
+            int r2, c2;
+            image(row[i], col[i], r2, c2);
+            int j = lookup(cellAt, key(r2, c2));
+            if (j == -1) {
+                ok = false;
+                break;
+            }
+            sym.cand[i] = j;
+            sym.seg[segs.rowSeg[i]] = swapped ? segs.colSeg[j] : segs.rowSeg[j];
+            sym.seg[segs.colSeg[i]] = swapped ? segs.rowSeg[j] : segs.colSeg[j];
         }
+        for (int k = 0; k < (int)outposts.size() && ok; k++) {
+            int r2, c2;
+            image(outposts[k].r, outposts[k].c, r2, c2);
+            int m = lookup(outpostAt, key(r2, c2));
+            if (m == -1 || outposts[m].req != outposts[k].req)
+                ok = false;
+            else
+                sym.outpost[k] = m;
+        }
+        if (ok)
+            found.push_back(sym);
+    }
+    return found;
+}
+
+template <size_t N>
+Result solveCase(const Segments& segs, const vector<Outpost>& outposts, Budget* budget) {
+    int E = segs.rowSeg.size();
+
+    // For each candidate, record which outposts it is adjacent to.
+    vector<vector<int>> candToOutposts(E);
+    for (int opIdx = 0; opIdx < (int)outposts.size(); opIdx++) {
+        for (int cand : outposts[opIdx].adj) {
+            candToOutposts[cand].push_back(opIdx);
+        }
+    }
 
-        // Precompute coverage and conflict bitsets for each candidate.
-        vector<bitset<MAX_CAND>> candCoverage(E), candConflict(E);
-        computeCoverage(R, C, grid, candidates, candCoverage, candConflict, candIndex);
+    // Order candidate indices by heuristic: those covering more cells come first.
+    // A candidate covers its two segments, sharing only its own cell.
+    vector<int> candCoverage(E);
+    for (int i = 0; i < E; i++)
+        candCoverage[i] = segs.cells[segs.rowSeg[i]].size() + segs.cells[segs.colSeg[i]].size() - 1;
+    vector<int> candOrder(E);
+    for (int i = 0; i < E; i++)
+        candOrder[i] = i;
+    sort(candOrder.begin(), candOrder.end(), [&](int a, int b) {
+        return candCoverage[a] > candCoverage[b];
+        });
 
-        // Process outposts (cells with digits) and record their adjacent candidate indices.
-        vector<Outpost> outposts = getOutposts(R, C, grid, candIndex);
+    SearchState<N> root;
+    initState(root, segs, outposts);
+    root.ttGen = tt.newCase();
+    // Only the cell branching excludes images of searched siblings (forbidImages).
+    if (opts.symmetry && opts.branching == BRANCH_CELL)
+        root.symmetries = findSymmetries(segs, outposts);
 
-        // For each candidate, record which outposts it is adjacent to.
-        vector<vector<int>> candToOutposts(E);
-        for (int opIdx = 0; opIdx < (int)outposts.size(); opIdx++) {
-            for (int cand : outposts[opIdx].adj) {
-                candToOutposts[cand].push_back(opIdx);
+    // Fix every forced turret before searching; a contradiction here means no
+    // placement exists at all.
+    if (!propagate(root, segs, outposts, candToOutposts))
+        return Result();
+    if (opts.dominance != DOMINANCE_OFF && pruneDominated(root, segs, candToOutposts) > 0
+        && !propagate(root, segs, outposts, candToOutposts))
+        return Result();
+    root.symmetric = (1 << root.symmetries.size()) - 1;
+
+    Bound bound;
+    bound.budget = budget;
+    bound.lowest = lowerBound(root, segs);
+    Result res;
+    res.lower = bound.lowest;
+    if (opts.search == SEARCH_DEEPENING) {
+        // Iterative deepening: try turret budgets from the lower bound up to E. Every
+        // budget searched to the end without a solution raises the lower bound.
+        size_t mark = root.trail.size();
+        for (int k = bound.lowest; k <= E; k++) {
+            bound.limit = k;
+            if (!(budget && budget->exhausted)) {
+                STAT(stats.rounds++);
+                runSearch(root, segs, outposts, candToOutposts, candOrder, bound);
+            }
+            undoTo(root, segs, candToOutposts, mark);
+            if (bound.found != -1)
+                break;
+            if (budget && budget->exhausted) {
+                res.optimal = false;
+                return res;
             }
+            res.lower = k + 1;
         }
+    } else {
+        // Branch and bound: the greedy count is the incumbent, so the search only has
+        // to find something smaller or prove there is nothing.
+        bound.found = greedyUpperBound(root, segs, outposts, candToOutposts, bound.best);
+        bound.limit = bound.found == -1 ? E : bound.found - 1;
+        if (bound.limit >= bound.lowest && !(budget && budget->exhausted))
+            runSearch(root, segs, outposts, candToOutposts, candOrder, bound);
+        // A search cut short still proves its answer if it met the root bound.
+        res.optimal = !(budget && budget->exhausted) || bound.found == bound.lowest;
+    }
+
+    res.count = bound.found;
+    if (res.optimal)
+        res.lower = max(res.count, 0);
+    for (int cand : bound.best)
+        res.turrets.push_back({ segs.line[segs.rowSeg[cand]], segs.line[segs.colSeg[cand]] });
+    return res;
+}
+
+// Searches below root (already propagated) within bound, on opts.threads threads.
+template <size_t N>
+void runSearch(SearchState<N>& root, const Segments& segs, const vector<Outpost>& outposts,
+    const vector<vector<int>>& candToOutposts, const vector<int>& candOrder, Bound& bound) {
+    STAT_TIMER(stats.searchMs);
+    tt.allocate();
+    if (opts.threads <= 1)
+        dfs(0, 0, root, segs, outposts, candToOutposts, candOrder, bound);
+    else
+        parallelSearch(root, segs, outposts, candToOutposts, candOrder, bound);
+    if (bound.budget)
+        returnBudget(*bound.budget);
+}
 
-        // Order candidate indices by heuristic: those covering more cells come first.
-        vector<int> candOrder(E);
-        for (int i = 0; i < E; i++)
-            candOrder[i] = i;
-        sort(candOrder.begin(), candOrder.end(), [&](int a, int b) {
-            return candCoverage[a].count() > candCoverage[b].count();
+// Every thread searches on its own copy of root. The first one starts with the root
+// task; while some thread is idle, busy ones hand out the siblings they have not
+// tried yet (expandNode) and idle ones steal them. The search ends when every deque
+// is empty and no thread holds a task, or when a solution proves optimal. The answer
+// does not depend on the thread count: the search is exhaustive up to the optimum.
+template <size_t N>
+void parallelSearch(const SearchState<N>& root, const Segments& segs, const vector<Outpost>& outposts,
+    const vector<vector<int>>& candToOutposts, const vector<int>& candOrder, Bound& bound) {
+    WorkPool<N> pool;
+    for (int id = 0; id < opts.threads; id++) {
+        pool.workers.emplace_back(new Worker<N>());
+        Worker<N>& w = *pool.workers.back();
+        w.id = id;
+        w.pool = &pool;
+        w.st = root;
+        w.st.worker = &w;
+        w.rootMark = root.trail.size();
+    }
+    pool.push(*pool.workers[0], Task());
+
+    vector<thread> threads;
+    for (int id = 0; id < opts.threads; id++)
+        threads.emplace_back([&, id]() {
+            runWorker(*pool.workers[id], segs, outposts, candToOutposts, candOrder, bound);
             });
+    for (thread& t : threads)
+        t.join();
+    for (const unique_ptr<Worker<N>>& w : pool.workers) {
+        nodeCount += w->nodes;
+        ttCuts += w->cuts;
+        dominated += w->dominated;
+        addStats(stats, w->stats);
+    }
+}
 
-        // fullCoverage: bitset with all candidate cells set.
-        bitset<MAX_CAND> fullCoverage;
-        fullCoverage.reset();
-        for (int i = 0; i < E; i++) {
-            fullCoverage.set(i);
-        }
-
-        bool solutionFound = false;
-        int best = INT_MAX;
-        vector<int> initOutCount(outposts.size(), 0);
-
-        // Iterative deepening: try turret counts from 1 to E.
-        for (int k = 1; k <= E; k++) {
-            best = k;
-            solutionFound = false;
-            bitset<MAX_CAND> initCoverage, initForbidden;
-            initCoverage.reset();
-            initForbidden.reset();
-            dfs(0, 0, initCoverage, initForbidden, initOutCount,
-                candCoverage, candConflict, outposts, candToOutposts,
-                fullCoverage, candOrder, best, solutionFound);
-            if (solutionFound) {
-                cout << k << "\n";
+template <size_t N>
+void runWorker(Worker<N>& w, const Segments& segs, const vector<Outpost>& outposts,
+    const vector<vector<int>>& candToOutposts, const vector<int>& candOrder, Bound& bound) {
+    WorkPool<N>& pool = *w.pool;
+    uint8_t rootSymmetric = w.st.symmetric;
+    Task task;
+    while (!bound.stop) {
+        if (!pool.take(w, task)) {
+            if (pool.queued == 0 && pool.busy == 0)
                 break;
+            this_thread::yield();
+            continue;
+        }
+        // The entries were made in this order on the same root, so replaying them
+        // is legal and rebuilds the donor's state plus the branch.
+        for (int entry : task) {
+            if (entry < 0)
+                forbidCandidate(w.st, segs, ~entry);
+            else
+                placeTurret(w.st, segs, candToOutposts, entry);
+        }
+        // Below the root, the symmetries left depend on the donor's path.
+        w.st.symmetric = task.empty() ? rootSymmetric : 0;
+        if (propagate(w.st, segs, outposts, candToOutposts))
+            dfs(0, 0, w.st, segs, outposts, candToOutposts, candOrder, bound);
+        undoTo(w.st, segs, candToOutposts, w.rootMark);
+        pool.busy--;
+    }
+    if (bound.budget)
+        returnBudget(*bound.budget);
+    w.nodes = nodeCount;
+    w.cuts = ttCuts;
+    w.dominated = dominated;
+    w.stats = stats;
+}
+
+// Fewer tasks waiting than threads without one.
+template <size_t N>
+bool WorkPool<N>::hungry() const {
+    return queued < (int)workers.size() - busy;
+}
+
+template <size_t N>
+void WorkPool<N>::push(Worker<N>& w, Task&& task) {
+    lock_guard<mutex> guard(w.lock);
+    w.tasks.push_back(move(task));
+    queued++;
+}
+
+// Counts the caller as busy while it looks, so that busy == 0 && queued == 0 means
+// no task is left anywhere.
+template <size_t N>
+bool WorkPool<N>::take(Worker<N>& w, Task& task) {
+    busy++;
+    int n = workers.size();
+    for (int k = 0; k < n; k++) {
+        Worker<N>& victim = *workers[(w.id + k) % n];
+        lock_guard<mutex> guard(victim.lock);
+        if (victim.tasks.empty())
+            continue;
+        if (k == 0) {
+            task = move(victim.tasks.back());
+            victim.tasks.pop_back();
+        } else {
+            task = move(victim.tasks.front());
+            victim.tasks.pop_front();
+        }
+        queued--;
+        return true;
+    }
+    busy--;
+    return false;
+}
+
+// Hands every available sibling from branch[first] on to the pool as its own task:
+// sibling j places branch[j] with the siblings before it excluded, along with their
+// images under the symmetries fixing st (forbidImages), exactly the subtree the
+// sequential loop in expandNode would search for it.
+template <size_t N>
+void donateSiblings(SearchState<N>& st, const Segments& segs, const vector<int>& branch, size_t first) {
+    Worker<N>& w = *st.worker;
+    Task prefix(st.trail.begin() + w.rootMark, st.trail.end());
+    int stamp = ++st.symStamp;
+    donations++;
+    for (size_t j = first; j < branch.size(); j++) {
+        if (!isAvailable(st, segs, branch[j]) || st.symMark[branch[j]] == stamp)
+            continue;
+        Task task = prefix;
+        task.push_back(branch[j]);
+        w.pool->push(w, move(task));
+        prefix.push_back(~branch[j]);
+        st.symMark[branch[j]] = stamp;
+        for (size_t k = 0; k < st.symmetries.size(); k++) {
+            int image = st.symmetries[k].cand[branch[j]];
+            if ((st.symmetric >> k & 1) && isAvailable(st, segs, image) && st.symMark[image] != stamp) {
+                prefix.push_back(~image);
+                st.symMark[image] = stamp;
             }
         }
-        if (!solutionFound)
-            cout << "noxus will rise!" << "\n";
     }
-    return 0;
 }
 
-void readGrid(int R, int C, vector<string>& grid) {
-    for (int i = 0; i < R; i++)
-        cin >> grid[i];
+void Input::open() {
+#ifdef INPUT_MMAP
+    struct stat st;
+    if (fstat(0, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+        void* map = mmap(nullptr, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, 0, 0);
+        if (map != MAP_FAILED) {
+            data = (char*)map;
+            size = st.st_size;
+            mapped = eof = true;
+            return;
+        }
+    }
+#endif
+}
+
+void Input::readAll() {
+    mark = 0;
+    while (refill()) {}
 }
 
-vector<Candidate> getCandidates(int R, int C, const vector<string>& grid, vector<vector<int>>& candIndex) {
+// Loads another block; false once stdin is exhausted.
+bool Input::refill() {
+    if (eof)
+        return false;
+    if (mark > 0) {
+        memmove(buf.data(), buf.data() + mark, size - mark);
+        size -= mark;
+        pos -= mark;
+        mark = 0;
+    }
+    if (buf.size() - size < INPUT_BLOCK)
+        buf.resize(max(buf.size() * 2, size + INPUT_BLOCK));
+    size_t n = fread(buf.data() + size, 1, buf.size() - size, stdin);
+    data = buf.data();
+    size += n;
+    if (n == 0)
+        eof = true;
+    return n > 0;
+}
+
+// Spaces, tabs, line ends and other control bytes separate tokens.
+inline bool isBlank(char ch) {
+    return (unsigned char)ch <= ' ';
+}
+
+// Next run of non-blank bytes, as its start relative to mark and its length.
+bool Input::token(size_t& start, size_t& len) {
+    for (;;) {
+        while (pos < size && isBlank(data[pos]))
+            pos++;
+        if (pos < size)
+            break;
+        if (!refill())
+            return false;
+    }
+    start = pos - mark;
+    for (;;) {
+        while (pos < size && !isBlank(data[pos]))
+            pos++;
+        if (pos < size || !refill())
+            break;
+    }
+    len = pos - mark - start;
+    return true;
+}
+
+bool Input::number(long long& v) {
+    size_t start, len;
+    if (!token(start, len))
+        return false;
+    v = 0;
+    for (size_t i = 0; i < len; i++)
+        v = v * 10 + (data[mark + start + i] - '0');
+    return true;
+}
+
+// Reads R, C and the rows of the next case into cs. The previous case's bytes may be
+// dropped from here on, so its grid must be done with.
+bool Input::readCase(Case& cs) {
+    mark = pos;
+    long long R, C;
+    if (!number(R) || !number(C))
+        return false;
+    rowStart.resize(R);
+    for (int i = 0; i < R; i++) {
+        size_t len;
+        if (!token(rowStart[i], len) || (long long)len != C)
+            return false;
+    }
+    size_t stride = R > 1 ? rowStart[1] - rowStart[0] : C;
+    for (int i = 2; i < R && stride != (size_t)C; i++)
+        if (rowStart[i] != rowStart[0] + i * stride)
+            stride = C;
+    char* first = data + mark + (R > 0 ? rowStart[0] : 0);
+    if (stride == (size_t)C)
+        for (int i = 1; i < R; i++)
+            memmove(first + i * C, data + mark + rowStart[i], C);
+    cs.R = R;
+    cs.C = C;
+    cs.grid.data = first;
+    cs.grid.stride = stride;
+    return true;
+}
+
+vector<Candidate> getCandidates(int R, int C, const Grid& grid, vector<vector<int>>& candIndex) {
     vector<Candidate> candidates;
     for (int i = 0; i < R; i++) {
         for (int j = 0; j < C; j++) {
@@ -120,7 +1352,7 @@ vector<Candidate> getCandidates(int R, int C, const vector<string>& grid, vector
     return candidates;
 }
 
-bool hasObstacle(int R, int C, const vector<string>& grid) {
+bool hasObstacle(int R, int C, const Grid& grid) {
     for (int i = 0; i < R; i++) {
         for (int j = 0; j < C; j++) {
             if (grid[i][j] != '.')
@@ -130,38 +1362,73 @@ bool hasObstacle(int R, int C, const vector<string>& grid) {
     return false;
 }
 
-void computeCoverage(int R, int C, const vector<string>& grid, const vector<Candidate>& candidates,
-    vector<bitset<MAX_CAND>>& candCoverage, vector<bitset<MAX_CAND>>& candConflict,
-    vector<vector<int>>& candIndex) {
-    int dr[4] = { 0, 0, 1, -1 };
-    int dc[4] = { 1, -1, 0, 0 };
-    int E = candidates.size();
-    for (int i = 0; i < E; i++) {
-        int r = candidates[i].r, c = candidates[i].c;
-        candCoverage[i].reset();
-        candCoverage[i].set(i); // covers itself
-        for (int d = 0; d < 4; d++) {
-            int nr = r + dr[d], nc = c + dc[d];
-            while (nr >= 0 && nr < R && nc >= 0 && nc < C && grid[nr][nc] == '.') {
-                candCoverage[i].set(candIndex[nr][nc]);
-                nr += dr[d];
-                nc += dc[d];
+// One pass per direction: a '.' cell continues the segment of its left (upper)
+// neighbour if that neighbour is also '.', and opens a new segment otherwise.
+Segments getSegments(int R, int C, const Grid& grid, const vector<vector<int>>& candIndex) {
+    Segments segs;
+    int E = 0;
+    for (int i = 0; i < R; i++)
+        for (int j = 0; j < C; j++)
+            if (grid[i][j] == '.')
+                E++;
+    segs.rowSeg.assign(E, -1);
+    segs.colSeg.assign(E, -1);
+
+    for (int i = 0; i < R; i++) {
+        for (int j = 0; j < C; j++) {
+            if (grid[i][j] != '.')
+                continue;
+            int idx = candIndex[i][j];
+            if (j > 0 && grid[i][j - 1] == '.')
+                segs.rowSeg[idx] = segs.rowSeg[candIndex[i][j - 1]];
+            else
+                segs.rowSeg[idx] = segs.numRow++;
+        }
+    }
+    for (int j = 0; j < C; j++) {
+        for (int i = 0; i < R; i++) {
+            if (grid[i][j] != '.')
+                continue;
+            int idx = candIndex[i][j];
+            if (i > 0 && grid[i - 1][j] == '.')
+                segs.colSeg[idx] = segs.colSeg[candIndex[i - 1][j]];
+            else
+                segs.colSeg[idx] = segs.numRow + segs.numCol++;
+        }
+    }
+
+    segs.cells.assign(segs.numRow + segs.numCol, vector<int>());
+    segs.line.assign(segs.numRow + segs.numCol, -1);
+    segs.start.assign(segs.numRow + segs.numCol, -1);
+    for (int i = 0; i < R; i++) {
+        for (int j = 0; j < C; j++) {
+            if (grid[i][j] != '.')
+                continue;
+            int idx = candIndex[i][j];
+            int rs = segs.rowSeg[idx], cs = segs.colSeg[idx];
+            if (segs.cells[rs].empty()) {
+                segs.line[rs] = i;
+                segs.start[rs] = j;
+            }
+            if (segs.cells[cs].empty()) {
+                segs.line[cs] = j;
+                segs.start[cs] = i;
             }
+            segs.cells[rs].push_back(idx);
+            segs.cells[cs].push_back(idx);
         }
-        // Conflict bitset: same as coverage but without itself.
-        candConflict[i] = candCoverage[i];
-        candConflict[i].reset(i);
     }
+    return segs;
 }
 
-vector<Outpost> getOutposts(int R, int C, const vector<string>& grid, const vector<vector<int>>& candIndex) {
+vector<Outpost> getOutposts(int R, int C, const Grid& grid, const vector<vector<int>>& candIndex) {
     vector<Outpost> outposts;
     int dr[4] = { 0, 0, 1, -1 };
     int dc[4] = { 1, -1, 0, 0 };
     for (int i = 0; i < R; i++) {
         for (int j = 0; j < C; j++) {
             if (isdigit(grid[i][j])) {
-                Outpost op = { i, j, grid[i][j] - '0' };
+                Outpost op = { i, j, grid[i][j] - '0', {} };
                 for (int d = 0; d < 4; d++) {
                     int ni = i + dr[d], nj = j + dc[d];
                     if (ni >= 0 && ni < R && nj >= 0 && nj < C && grid[ni][nj] == '.') {
@@ -175,84 +1442,1259 @@ vector<Outpost> getOutposts(int R, int C, const vector<string>& grid, const vect
     return outposts;
 }
 
-void dfs(int pos, int count, bitset<MAX_CAND> currCoverage, bitset<MAX_CAND> forbidden, vector<int>& outCount,
-    const vector<bitset<MAX_CAND>>& candCoverage, const vector<bitset<MAX_CAND>>& candConflict,
-    const vector<Outpost>& outposts, const vector<vector<int>>& candToOutposts,
-    bitset<MAX_CAND> fullCoverage, const vector<int>& candOrder, int& best, bool& solutionFound) {
-    if (solutionFound)
-        return;
-    if (count == best) {
-        if (currCoverage == fullCoverage) {
-            bool valid = true;
-            for (size_t i = 0; i < outposts.size(); i++) {
-                if (outCount[i] != outposts[i].req) {
-                    valid = false;
+void buildCrossMasks(Segments& segs, int words) {
+    segs.maskWords = words;
+    segs.rowCross.assign((size_t)segs.numRow * words, 0);
+    int E = segs.rowSeg.size();
+    for (int i = 0; i < E; i++) {
+        int cs = segs.colSeg[i];
+        segs.rowCross[(size_t)segs.rowSeg[i] * words + (cs >> 6)] |= uint64_t(1) << (cs & 63);
+    }
+}
+
+// True if every candidate cell lies in at least one lit segment.
+template <size_t N>
+bool coversAll(const SegMask<N>& lit, const Segments& segs) {
+    return coverKernel(segs.rowCross.data(), segs.numRow, lit.w, N / 64);
+}
+
+bool coverScalar(const uint64_t* rows, int numRows, const uint64_t* lit, int words) {
+    for (int k = 0; k < words; k++) {
+        uint64_t acc = 0;
+        for (int r = 0; r < numRows; r++)
+            if (!((lit[r >> 6] >> (r & 63)) & 1))
+                acc |= rows[(size_t)r * words + k];
+        if (acc & ~lit[k])
+            return false;
+    }
+    return true;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+// The wider kernels process 2, 4 or 8 words per step and hand masks narrower than
+// that to the next smaller kernel; capacities are powers of two, so widths divide.
+__attribute__((target("sse2")))
+bool coverSse2(const uint64_t* rows, int numRows, const uint64_t* lit, int words) {
+    if (words < 2)
+        return coverScalar(rows, numRows, lit, words);
+    for (int k = 0; k < words; k += 2) {
+        __m128i acc = _mm_setzero_si128();
+        for (int r = 0; r < numRows; r++)
+            if (!((lit[r >> 6] >> (r & 63)) & 1))
+                acc = _mm_or_si128(acc, _mm_loadu_si128((const __m128i*)(rows + (size_t)r * words + k)));
+        __m128i outside = _mm_andnot_si128(_mm_loadu_si128((const __m128i*)(lit + k)), acc);
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(outside, _mm_setzero_si128())) != 0xFFFF)
+            return false;
+    }
+    return true;
+}
+
+__attribute__((target("avx2")))
+bool coverAvx2(const uint64_t* rows, int numRows, const uint64_t* lit, int words) {
+    if (words < 4)
+        return coverSse2(rows, numRows, lit, words);
+    for (int k = 0; k < words; k += 4) {
+        __m256i acc = _mm256_setzero_si256();
+        for (int r = 0; r < numRows; r++)
+            if (!((lit[r >> 6] >> (r & 63)) & 1))
+                acc = _mm256_or_si256(acc, _mm256_loadu_si256((const __m256i*)(rows + (size_t)r * words + k)));
+        __m256i outside = _mm256_andnot_si256(_mm256_loadu_si256((const __m256i*)(lit + k)), acc);
+        if (!_mm256_testz_si256(outside, outside))
+            return false;
+    }
+    return true;
+}
+
+__attribute__((target("avx512f")))
+bool coverAvx512(const uint64_t* rows, int numRows, const uint64_t* lit, int words) {
+    if (words < 8)
+        return coverAvx2(rows, numRows, lit, words);
+    for (int k = 0; k < words; k += 8) {
+        __m512i acc = _mm512_setzero_si512();
+        for (int r = 0; r < numRows; r++)
+            if (!((lit[r >> 6] >> (r & 63)) & 1))
+                acc = _mm512_or_si512(acc, _mm512_loadu_si512(rows + (size_t)r * words + k));
+        __m512i unlit = _mm512_xor_si512(_mm512_loadu_si512(lit + k), _mm512_set1_epi64(-1));
+        if (_mm512_test_epi64_mask(acc, unlit))
+            return false;
+    }
+    return true;
+}
+#else
+bool coverSse2(const uint64_t* rows, int numRows, const uint64_t* lit, int words) {
+    return coverScalar(rows, numRows, lit, words);
+}
+bool coverAvx2(const uint64_t* rows, int numRows, const uint64_t* lit, int words) {
+    return coverScalar(rows, numRows, lit, words);
+}
+bool coverAvx512(const uint64_t* rows, int numRows, const uint64_t* lit, int words) {
+    return coverScalar(rows, numRows, lit, words);
+}
+#endif
+
+// Points the kernels at the requested instruction set, or the widest one available
+// for SIMD_AUTO. Returns false if the CPU lacks the requested one.
+bool selectKernels(SimdLevel level) {
+    bool sse2 = false, avx2 = false, avx512 = false;
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    sse2 = __builtin_cpu_supports("sse2");
+    avx2 = __builtin_cpu_supports("avx2");
+    avx512 = __builtin_cpu_supports("avx512f");
+#endif
+    if (level == SIMD_AUTO)
+        level = avx512 ? SIMD_AVX512 : avx2 ? SIMD_AVX2 : sse2 ? SIMD_SSE2 : SIMD_SCALAR;
+    switch (level) {
+    case SIMD_AVX512:
+        coverKernel = coverAvx512;
+        return avx512;
+    case SIMD_AVX2:
+        coverKernel = coverAvx2;
+        return avx2;
+    case SIMD_SSE2:
+        coverKernel = coverSse2;
+        return sse2;
+    default:
+        coverKernel = coverScalar;
+        return true;
+    }
+}
+
+// Every cell lit and every outpost at exactly its required count.
+template <size_t N>
+bool isSolution(const SearchState<N>& st, const Segments& segs, const vector<Outpost>& outposts) {
+    for (size_t i = 0; i < outposts.size(); i++)
+        if (st.outCount[i] != outposts[i].req)
+            return false;
+    return coversAll(st.occupied, segs);
+}
+
+template <size_t N>
+void initState(SearchState<N>& st, const Segments& segs, const vector<Outpost>& outposts) {
+    int E = segs.rowSeg.size();
+    int S = segs.numRow + segs.numCol;
+    st.occupied.reset();
+    st.forbidden.assign(E, 0);
+    st.outCount.assign(outposts.size(), 0);
+    st.count = 0;
+    uint64_t seed = 0;
+    st.zSeg.resize(S);
+    for (int s = 0; s < S; s++)
+        st.zSeg[s] = splitmix64(seed++);
+    st.zExcluded.resize(E);
+    for (int i = 0; i < E; i++)
+        st.zExcluded[i] = splitmix64(seed++);
+    st.zOutpost.resize(5 * outposts.size());
+    for (size_t k = 0; k < st.zOutpost.size(); k++)
+        st.zOutpost[k] = splitmix64(seed++);
+    st.hash = 0;
+    for (size_t opIdx = 0; opIdx < outposts.size(); opIdx++)
+        st.hash ^= st.zOutpost[5 * opIdx];
+    // Each candidate is placed or forbidden at most once along a path.
+    st.trail.clear();
+    st.trail.reserve(E);
+    st.segAvail.assign(S, 0);
+    for (int i = 0; i < E; i++) {
+        st.segAvail[segs.rowSeg[i]]++;
+        st.segAvail[segs.colSeg[i]]++;
+    }
+    // The first propagate has to look at every cell.
+    st.pending.clear();
+    st.pending.reserve(S);
+    st.inPending.assign(S, 1);
+    for (int s = 0; s < S; s++)
+        st.pending.push_back(s);
+    st.packed.clear();
+    st.packed.reserve(E);
+    st.segComp.assign(S, -1);
+    st.segDeg.assign(S, 0);
+    st.compQueue.reserve(S);
+    st.compStart.reserve(S + 1);
+    st.compPacked.reserve(S);
+    st.mate.assign(S, -1);
+    st.seen.assign(S, 0);
+    st.seenStamp = 0;
+    st.degBuf.reserve(S);
+    size_t widest = 4; // an outpost has at most four neighbours
+    for (int i = 0; i < E; i++)
+        widest = max(widest, segs.cells[segs.rowSeg[i]].size() + segs.cells[segs.colSeg[i]].size());
+    // Every dfs level adds at least one trail entry, so depth stays within E + 1.
+    st.branchBuf.assign(E + 2, vector<int>());
+    for (vector<int>& branch : st.branchBuf)
+        branch.reserve(widest);
+    st.symmetries.clear();
+    st.symmetric = 0;
+    st.symMark.assign(E, 0);
+    st.symStamp = 0;
+}
+
+template <size_t N>
+bool isAvailable(const SearchState<N>& st, const Segments& segs, int cand) {
+    return !st.forbidden[cand] && !st.occupied.test(segs.rowSeg[cand]) && !st.occupied.test(segs.colSeg[cand]);
+}
+
+// Forbidden, but with both segments still free: such exclusions are part of the key.
+template <size_t N>
+bool isOpenExclusion(const SearchState<N>& st, const Segments& segs, int cand) {
+    return st.forbidden[cand] && !st.occupied.test(segs.rowSeg[cand]) && !st.occupied.test(segs.colSeg[cand]);
+}
+
+template <size_t N>
+void markUnavailable(SearchState<N>& st, const Segments& segs, int cand) {
+    for (int s : { segs.rowSeg[cand], segs.colSeg[cand] }) {
+        if (--st.segAvail[s] <= 2 && !st.inPending[s]) {
+            st.inPending[s] = 1;
+            st.pending.push_back(s);
+        }
+    }
+}
+
+template <size_t N>
+void markAvailable(SearchState<N>& st, const Segments& segs, int cand) {
+    st.segAvail[segs.rowSeg[cand]]++;
+    st.segAvail[segs.colSeg[cand]]++;
+}
+
+template <size_t N>
+void clearPending(SearchState<N>& st) {
+    for (int s : st.pending)
+        st.inPending[s] = 0;
+    st.pending.clear();
+}
+
+// Occupying the two segments takes every candidate in them out of play, cand included.
+template <size_t N>
+void placeTurret(SearchState<N>& st, const Segments& segs, const vector<vector<int>>& candToOutposts, int cand) {
+    int rs = segs.rowSeg[cand], cs = segs.colSeg[cand];
+    for (int other : segs.cells[rs]) {
+        if (isAvailable(st, segs, other))
+            markUnavailable(st, segs, other);
+        else if (isOpenExclusion(st, segs, other))
+            st.hash ^= st.zExcluded[other];
+    }
+    for (int other : segs.cells[cs]) {
+        if (other == cand)
+            continue;
+        if (isAvailable(st, segs, other))
+            markUnavailable(st, segs, other);
+        else if (isOpenExclusion(st, segs, other))
+            st.hash ^= st.zExcluded[other];
+    }
+    st.occupied.set(rs);
+    st.occupied.set(cs);
+    for (int opIdx : candToOutposts[cand]) {
+        st.hash ^= st.zOutpost[5 * opIdx + st.outCount[opIdx]];
+        st.outCount[opIdx]++;
+        st.hash ^= st.zOutpost[5 * opIdx + st.outCount[opIdx]];
+    }
+    st.count++;
+    st.hash ^= st.zSeg[rs] ^ st.zSeg[cs];
+    st.trail.push_back(cand);
+}
+
+template <size_t N>
+void forbidCandidate(SearchState<N>& st, const Segments& segs, int cand) {
+    if (isAvailable(st, segs, cand)) {
+        markUnavailable(st, segs, cand);
+        st.hash ^= st.zExcluded[cand];
+    }
+    st.forbidden[cand] = 1;
+    st.trail.push_back(~cand);
+}
+
+template <size_t N>
+void undoTo(SearchState<N>& st, const Segments& segs, const vector<vector<int>>& candToOutposts, size_t mark) {
+    while (st.trail.size() > mark) {
+        int entry = st.trail.back();
+        st.trail.pop_back();
+        if (entry < 0) {
+            st.forbidden[~entry] = 0;
+            if (isAvailable(st, segs, ~entry)) {
+                markAvailable(st, segs, ~entry);
+                st.hash ^= st.zExcluded[~entry];
+            }
+            continue;
+        }
+        int rs = segs.rowSeg[entry], cs = segs.colSeg[entry];
+        st.occupied.reset(rs);
+        st.occupied.reset(cs);
+        for (int other : segs.cells[rs]) {
+            if (isAvailable(st, segs, other))
+                markAvailable(st, segs, other);
+            else if (isOpenExclusion(st, segs, other))
+                st.hash ^= st.zExcluded[other];
+        }
+        for (int other : segs.cells[cs]) {
+            if (other == entry)
+                continue;
+            if (isAvailable(st, segs, other))
+                markAvailable(st, segs, other);
+            else if (isOpenExclusion(st, segs, other))
+                st.hash ^= st.zExcluded[other];
+        }
+        for (int opIdx : candToOutposts[entry]) {
+            st.hash ^= st.zOutpost[5 * opIdx + st.outCount[opIdx]];
+            st.outCount[opIdx]--;
+            st.hash ^= st.zOutpost[5 * opIdx + st.outCount[opIdx]];
+        }
+        st.count--;
+        st.hash ^= st.zSeg[rs] ^ st.zSeg[cs];
+    }
+}
+
+// Applies the forcing rules until nothing changes:
+//  - an outpost with as many free neighbours as missing turrets gets all of them;
+//  - a saturated outpost (including every '0') forbids its remaining neighbours;
+//  - an uncovered cell with a single possible coverer gets that turret.
+// Returns false as soon as an outpost overflows or can no longer be met, or a cell
+// can no longer be covered. Cells are only rechecked in segments on the pending list.
+template <size_t N>
+bool propagate(SearchState<N>& st, const Segments& segs, const vector<Outpost>& outposts,
+    const vector<vector<int>>& candToOutposts) {
+    bool changed = true;
+    while (changed) {
+        changed = false;
+
+        for (size_t opIdx = 0; opIdx < outposts.size(); opIdx++) {
+            const Outpost& op = outposts[opIdx];
+            int needed = op.req - st.outCount[opIdx];
+            if (needed < 0) {
+                STAT(stats.overflowPrunes++);
+                clearPending(st);
+                return false;
+            }
+            int possible = 0;
+            for (int cand : op.adj)
+                if (isAvailable(st, segs, cand))
+                    possible++;
+            if (possible < needed) {
+                STAT(stats.outpostPrunes++);
+                clearPending(st);
+                return false;
+            }
+            if (possible == 0 || (needed > 0 && possible > needed))
+                continue;
+            // Either saturated (needed == 0) or every free neighbour is required.
+            for (int cand : op.adj) {
+                if (!isAvailable(st, segs, cand))
+                    continue;
+                if (needed == 0)
+                    forbidCandidate(st, segs, cand);
+                else
+                    placeTurret(st, segs, candToOutposts, cand);
+            }
+            changed = true;
+        }
+        if (changed)
+            continue;
+
+        // A cell's coverers are those of its two segments, with the cell itself
+        // counted in both.
+        while (!changed && !st.pending.empty()) {
+            int s = st.pending.back();
+            st.pending.pop_back();
+            st.inPending[s] = 0;
+            if (st.occupied.test(s))
+                continue;
+            for (int i : segs.cells[s]) {
+                int rs = segs.rowSeg[i], cs = segs.colSeg[i];
+                if (st.occupied.test(rs) || st.occupied.test(cs))
+                    continue;
+                int coverers = st.segAvail[rs] + st.segAvail[cs] - (st.forbidden[i] ? 0 : 1);
+                if (coverers == 0) {
+                    STAT(stats.coverPrunes++);
+                    clearPending(st);
+                    return false;
+                }
+                if (coverers > 1)
+                    continue;
+                int forced = -1;
+                for (int cand : segs.cells[rs])
+                    if (isAvailable(st, segs, cand))
+                        forced = cand;
+                for (int cand : segs.cells[cs])
+                    if (isAvailable(st, segs, cand))
+                        forced = cand;
+                // Look at s again once the placement has settled.
+                if (!st.inPending[s]) {
+                    st.inPending[s] = 1;
+                    st.pending.push_back(s);
+                }
+                placeTurret(st, segs, candToOutposts, forced);
+                changed = true;
+                break;
+            }
+        }
+    }
+    return true;
+}
+
+// Admissible bound on the turrets of any solution below st. The uncovered-cell graph
+// has the free segments as vertices and, for every uncovered cell, an edge between
+// its row and its column segment. An available candidate is an uncovered cell, so
+// each turret still to come sits inside one component of that graph and lights only
+// segments of it: the bound is the turrets placed plus, per component, the larger of
+//  - a greedy packing of uncovered cells no single available turret can cover
+//    together. Two uncovered cells share a coverer iff they share a segment or the
+//    crossing of one's row segment with the other's column segment is still
+//    available; cells of different components never do.
+//  - segmentCoverBound.
+template <size_t N>
+int lowerBound(SearchState<N>& st, const Segments& segs) {
+    int E = segs.rowSeg.size();
+    int numComp = labelComponents(st, segs);
+    st.compPacked.assign(numComp, 0);
+    vector<int>& packed = st.packed;
+    packed.clear();
+    for (int i = 0; i < E; i++) {
+        int rs = segs.rowSeg[i], cs = segs.colSeg[i];
+        if (st.occupied.test(rs) || st.occupied.test(cs))
+            continue;
+        bool independent = true;
+        for (int j : packed) {
+            int rs2 = segs.rowSeg[j], cs2 = segs.colSeg[j];
+            if (st.segComp[rs2] != st.segComp[rs])
+                continue;
+            int x = crossing(segs, rs, cs2), y = crossing(segs, rs2, cs);
+            if (rs == rs2 || cs == cs2 || (x != -1 && !st.forbidden[x]) || (y != -1 && !st.forbidden[y])) {
+                independent = false;
+                break;
+            }
+        }
+        if (independent) {
+            packed.push_back(i);
+            st.compPacked[st.segComp[rs]]++;
+        }
+    }
+    int total = st.count;
+    for (int k = 0; k < numComp; k++)
+        total += max(st.compPacked[k], segmentCoverBound(st, segs, k));
+    return total;
+}
+
+// Labels the components of the uncovered-cell graph in st.segComp, lists their
+// segments in compQueue/compStart and counts each segment's uncovered cells.
+// Returns the number of components.
+template <size_t N>
+int labelComponents(SearchState<N>& st, const Segments& segs) {
+    int E = segs.rowSeg.size();
+    fill(st.segComp.begin(), st.segComp.end(), -1);
+    st.compQueue.clear();
+    st.compStart.clear();
+    for (int i = 0; i < E; i++) {
+        int rs = segs.rowSeg[i], cs = segs.colSeg[i];
+        if (st.segComp[rs] != -1 || st.occupied.test(rs) || st.occupied.test(cs))
+            continue;
+        int k = st.compStart.size();
+        st.compStart.push_back(st.compQueue.size());
+        st.segComp[rs] = k;
+        st.compQueue.push_back(rs);
+        for (size_t head = st.compStart[k]; head < st.compQueue.size(); head++) {
+            int s = st.compQueue[head];
+            bool isRow = s < segs.numRow;
+            st.segDeg[s] = 0;
+            for (int j : segs.cells[s]) {
+                int other = isRow ? segs.colSeg[j] : segs.rowSeg[j];
+                if (st.occupied.test(other))
+                    continue;
+                st.segDeg[s]++;
+                if (st.segComp[other] == -1) {
+                    st.segComp[other] = k;
+                    st.compQueue.push_back(other);
+                }
+            }
+        }
+    }
+    st.compStart.push_back(st.compQueue.size());
+    return st.compStart.size() - 1;
+}
+
+// Bound from the segments of component k alone. Every turret lights one row and one
+// column segment, so t turrets leave the component covered only if the lit rows R'
+// and columns C' satisfy |R'| <= t, |C'| <= t and cover every uncovered cell. For the
+// set S of s rows left dark, all their uncovered cells need a lit column:
+// |C'| >= |N(S)|, which is at least the s-th smallest row degree and, by König's
+// theorem, at least s minus the deficiency (rows minus maximum matching) of the
+// component. Hence t >= min over s of max(rows - s, |N(S)|), and the same for the
+// columns. On an open a x b room this gives min(a, b) exactly.
+template <size_t N>
+int segmentCoverBound(SearchState<N>& st, const Segments& segs, int k) {
+    int first = st.compStart[k], last = st.compStart[k + 1];
+    int rows = 0, matched = 0;
+    for (int q = first; q < last; q++)
+        st.mate[st.compQueue[q]] = -1;
+    for (int q = first; q < last; q++) {
+        int s = st.compQueue[q];
+        if (s >= segs.numRow)
+            continue;
+        rows++;
+        st.seenStamp++;
+        if (augment(st, segs, s))
+            matched++;
+    }
+    int cols = (last - first) - rows;
+
+    int best = 0;
+    for (int side = 0; side < 2; side++) {
+        vector<int>& deg = st.degBuf;
+        deg.clear();
+        for (int q = first; q < last; q++) {
+            int s = st.compQueue[q];
+            if ((s < segs.numRow) == (side == 0))
+                deg.push_back(st.segDeg[s]);
+        }
+        sort(deg.begin(), deg.end());
+        int n = side == 0 ? rows : cols;
+        best = max(best, sideBound(deg, n, n - matched));
+    }
+    return best;
+}
+
+// Kuhn's augmenting path search from row segment rs over uncovered cells.
+template <size_t N>
+bool augment(SearchState<N>& st, const Segments& segs, int rs) {
+    for (int j : segs.cells[rs]) {
+        int cs = segs.colSeg[j];
+        if (st.occupied.test(cs) || st.seen[cs] == st.seenStamp)
+            continue;
+        st.seen[cs] = st.seenStamp;
+        if (st.mate[cs] == -1 || augment(st, segs, st.mate[cs])) {
+            st.mate[cs] = rs;
+            st.mate[rs] = cs;
+            return true;
+        }
+    }
+    return false;
+}
+
+// min over s of max(n - s, |N(S)|) for one side of a component with n segments,
+// degrees deg in ascending order and the given matching deficiency.
+int sideBound(const vector<int>& deg, int n, int deficiency) {
+    int best = n;
+    for (int s = 1; s <= n; s++)
+        best = min(best, max(n - s, max(deg[s - 1], s - deficiency)));
+    return best;
+}
+
+// Quick incumbent: repeatedly propagate, then light the most constrained cell with
+// the coverer that lights the most uncovered cells. Returns the turret count of the
+// placement it reaches, left in placement, or -1 if it runs into a contradiction.
+// st is left unchanged.
+template <size_t N>
+int greedyUpperBound(SearchState<N>& st, const Segments& segs, const vector<Outpost>& outposts,
+    const vector<vector<int>>& candToOutposts, vector<int>& placement) {
+    size_t mark = st.trail.size();
+    vector<int>& branch = st.branchBuf[0];
+    int result = -1;
+    while (true) {
+        if (!propagate(st, segs, outposts, candToOutposts))
+            break;
+        getBranchSet(st, segs, outposts, branch);
+        if (branch.empty()) {
+            result = isSolution(st, segs, outposts) ? st.count : -1;
+            placement.clear();
+            if (result != -1)
+                for (int entry : st.trail)
+                    if (entry >= 0)
+                        placement.push_back(entry);
+            break;
+        }
+        int pick = -1, pickGain = -1;
+        for (int cand : branch) {
+            int gain = 0;
+            for (int j : segs.cells[segs.rowSeg[cand]])
+                if (!st.occupied.test(segs.colSeg[j]))
+                    gain++;
+            for (int j : segs.cells[segs.colSeg[cand]])
+                if (!st.occupied.test(segs.rowSeg[j]))
+                    gain++;
+            if (gain > pickGain) {
+                pickGain = gain;
+                pick = cand;
+            }
+        }
+        placeTurret(st, segs, candToOutposts, pick);
+    }
+    undoTo(st, segs, candToOutposts, mark);
+    return result;
+}
+
+// Forbids every candidate that another one does at least as well as, and returns how
+// many. A is dominated by B when both are available, they share a segment s, neither
+// has a neighbouring outpost, every cell of A's other segment but A itself is lit, and
+// B is the only available candidate of its own other segment. Then A lights no dark
+// cell B doesn't, and B rules out no available candidate A doesn't, so swapping A for
+// B in a solution below st gives one of the same size. Each exclusion is checked on
+// the state left by the ones before it, and passes repeat until nothing changes.
+template <size_t N>
+int pruneDominated(SearchState<N>& st, const Segments& segs, const vector<vector<int>>& candToOutposts) {
+    int S = segs.numRow + segs.numCol;
+    int removed = 0;
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (int s = 0; s < S; s++) {
+            if (st.occupied.test(s) || st.segAvail[s] < 2)
+                continue;
+            int keep = -1;
+            for (int cand : segs.cells[s]) {
+                if (isAvailable(st, segs, cand) && candToOutposts[cand].empty()
+                    && st.segAvail[otherSegment(segs, cand, s)] == 1) {
+                    keep = cand;
                     break;
                 }
             }
-            if (valid) {
-                solutionFound = true;
+            if (keep == -1)
+                continue;
+            for (int cand : segs.cells[s]) {
+                if (cand == keep || !isAvailable(st, segs, cand) || !candToOutposts[cand].empty())
+                    continue;
+                int other = otherSegment(segs, cand, s);
+                bool dark = false;
+                for (int cell : segs.cells[other]) {
+                    if (cell != cand && !st.occupied.test(otherSegment(segs, cell, other))) {
+                        dark = true;
+                        break;
+                    }
+                }
+                if (dark)
+                    continue;
+                forbidCandidate(st, segs, cand);
+                removed++;
+                changed = true;
+            }
+        }
+    }
+    dominated += removed;
+    return removed;
+}
+
+// The segment of cand that is not s.
+int otherSegment(const Segments& segs, int cand, int s) {
+    return segs.rowSeg[cand] == s ? segs.colSeg[cand] : segs.rowSeg[cand];
+}
+
+// The symmetries among mask that map st onto itself: lit segments onto lit ones,
+// available candidates onto available ones and every outpost onto one with as many
+// turrets. Solutions below st then map onto solutions below st of the same size.
+template <size_t N>
+uint8_t stateSymmetries(const SearchState<N>& st, const Segments& segs, uint8_t mask) {
+    int E = segs.rowSeg.size();
+    int S = segs.numRow + segs.numCol;
+    for (size_t k = 0; k < st.symmetries.size(); k++) {
+        if (!(mask >> k & 1))
+            continue;
+        const Symmetry& sym = st.symmetries[k];
+        bool fixed = true;
+        for (int s = 0; s < S && fixed; s++)
+            fixed = st.occupied.test(s) == st.occupied.test(sym.seg[s]);
+        for (int i = 0; i < E && fixed; i++)
+            fixed = isAvailable(st, segs, i) == isAvailable(st, segs, sym.cand[i]);
+        for (size_t o = 0; o < st.outCount.size() && fixed; o++)
+            fixed = st.outCount[o] == st.outCount[sym.outpost[o]];
+        if (!fixed)
+            mask &= ~(1 << k);
+    }
+    return mask;
+}
+
+// Forbids the available images of cand under the symmetries fixing st, once the
+// child placing cand is searched. A solution below st through an image of cand maps
+// onto one through cand itself, of the same size, which that child already saw;
+// so later siblings need neither cand nor its images. These exclusions reach into
+// the whole sibling subtrees, long after the state stops being symmetric.
+template <size_t N>
+void forbidImages(SearchState<N>& st, const Segments& segs, int cand) {
+    for (size_t k = 0; k < st.symmetries.size(); k++) {
+        if (!(st.symmetric >> k & 1))
+            continue;
+        int image = st.symmetries[k].cand[cand];
+        if (isAvailable(st, segs, image))
+            forbidCandidate(st, segs, image);
+    }
+}
+
+// Collects the candidates to branch on in BRANCH_CELL mode: the available coverers of
+// the uncovered cell with the fewest of them or, once every cell is covered, the free
+// neighbours of the first outpost still short of turrets. Any solution below this
+// node places one of them.
+template <size_t N>
+void getBranchSet(SearchState<N>& st, const Segments& segs, const vector<Outpost>& outposts, vector<int>& branch) {
+    int E = segs.rowSeg.size();
+    const vector<int>& segAvail = st.segAvail;
+    branch.clear();
+    int bestCell = -1, bestCoverers = INT_MAX;
+    for (int i = 0; i < E; i++) {
+        int rs = segs.rowSeg[i], cs = segs.colSeg[i];
+        if (st.occupied.test(rs) || st.occupied.test(cs))
+            continue;
+        int coverers = segAvail[rs] + segAvail[cs] - (st.forbidden[i] ? 0 : 1);
+        if (coverers < bestCoverers) {
+            bestCoverers = coverers;
+            bestCell = i;
+        }
+    }
+    if (bestCell != -1) {
+        for (int cand : segs.cells[segs.rowSeg[bestCell]])
+            if (isAvailable(st, segs, cand))
+                branch.push_back(cand);
+        for (int cand : segs.cells[segs.colSeg[bestCell]])
+            if (cand != bestCell && isAvailable(st, segs, cand))
+                branch.push_back(cand);
+        return;
+    }
+
+    for (size_t opIdx = 0; opIdx < outposts.size(); opIdx++) {
+        if (st.outCount[opIdx] == outposts[opIdx].req)
+            continue;
+        for (int cand : outposts[opIdx].adj)
+            if (isAvailable(st, segs, cand))
+                branch.push_back(cand);
+        return;
+    }
+}
+
+// Searches below st for a solution within the budget in bound. Nodes whose lower bound
+// or transposition table entry exceeds the budget are cut; a node searched to the end
+// without a solution leaves its proven bound in the table. A node that handed part of
+// its subtree to the pool, itself or further down, leaves nothing: the bound only
+// holds once those tasks are done, and its node count misses their work.
+template <size_t N>
+void dfs(int pos, int depth, SearchState<N>& st, const Segments& segs, const vector<Outpost>& outposts,
+    const vector<vector<int>>& candToOutposts, const vector<int>& candOrder, Bound& bound) {
+    if (bound.stop || st.count > bound.limit)
+        return;
+    if (bound.budget && budgetLeft-- == 0 && outOfBudget(*bound.budget)) {
+        bound.stop = true;
+        return;
+    }
+    nodeCount++;
+    STAT(stats.maxDepth = max(stats.maxDepth, depth));
+    // Dropping dominated candidates keeps some optimal solution below the node, so
+    // what is proven below holds for the node as it came in. Turrets placed by the
+    // propagation that follows go through the checks below like any others.
+    if (opts.dominance == DOMINANCE_SEARCH && pruneDominated(st, segs, candToOutposts) > 0
+        && (!propagate(st, segs, outposts, candToOutposts) || st.count > bound.limit))
+        return;
+
+    if (isSolution(st, segs, outposts)) {
+        recordSolution(bound, st.count, st.trail);
+        return;
+    }
+    if (st.count == bound.limit) {
+        STAT(stats.boundPrunes++);
+        return;
+    }
+    // The subproblem depends only on the state, not on the path or pos: candidates of
+    // candOrder before pos are all placed, forbidden or unavailable.
+    uint64_t key = st.hash;
+    if (tt.enabled() && tt.probe(key, st.ttGen) > bound.limit) {
+        ttCuts++;
+        return;
+    }
+    if (lowerBound(st, segs) > bound.limit) {
+        STAT(stats.boundPrunes++);
+        return;
+    }
+
+    long long nodesBefore = nodeCount, donationsBefore = donations;
+    uint8_t inherited = st.symmetric;
+    if (inherited)
+        st.symmetric = stateSymmetries(st, segs, inherited);
+    expandNode(pos, depth, st, segs, outposts, candToOutposts, candOrder, bound);
+    st.symmetric = inherited;
+    // Solutions found inside lowered the limit, so limit + 1 holds for the whole subtree.
+    if (tt.enabled() && !bound.stop && donations == donationsBefore)
+        tt.store(key, st.ttGen, bound.limit + 1, nodeCount - nodesBefore);
+}
+
+// Branches on the next available candidate of candOrder from pos (BRANCH_ORDER) or on
+// the set from getBranchSet (BRANCH_CELL); each child is propagated before going deeper
+// and undone afterwards. Exclusions made for later siblings stay on the trail for the
+// caller to undo.
+template <size_t N>
+void expandNode(int pos, int depth, SearchState<N>& st, const Segments& segs, const vector<Outpost>& outposts,
+    const vector<vector<int>>& candToOutposts, const vector<int>& candOrder, Bound& bound) {
+    if (opts.branching == BRANCH_CELL) {
+        vector<int>& branch = st.branchBuf[depth];
+        getBranchSet(st, segs, outposts, branch);
+        // Child j places branch[j]; the ones before it are forbidden, so no placement
+        // is reached twice.
+        for (size_t j = 0; j < branch.size(); j++) {
+            int candIdx = branch[j];
+            if (!isAvailable(st, segs, candIdx))
+                continue; // taken out by propagating an earlier sibling's exclusion
+            if (st.worker && depth < SPLIT_DEPTH && st.worker->pool->hungry()) {
+                donateSiblings(st, segs, branch, j);
+                return;
+            }
+            size_t mark = st.trail.size();
+            placeTurret(st, segs, candToOutposts, candIdx);
+            if (propagate(st, segs, outposts, candToOutposts))
+                dfs(pos, depth + 1, st, segs, outposts, candToOutposts, candOrder, bound);
+            undoTo(st, segs, candToOutposts, mark);
+            if (bound.stop)
+                return;
+
+            int before = st.count;
+            forbidCandidate(st, segs, candIdx);
+            if (st.symmetric)
+                forbidImages(st, segs, candIdx);
+            if (!propagate(st, segs, outposts, candToOutposts))
+                return;
+            if (st.count != before) {
+                // Propagation placed turrets, which may have covered the cell or met
+                // the outpost: re-pick the branch set from this state.
+                dfs(pos, depth + 1, st, segs, outposts, candToOutposts, candOrder, bound);
+                return;
             }
         }
         return;
     }
+
     int nOrder = candOrder.size();
-    if (count + (nOrder - pos) < best)
+    while (pos < nOrder && !isAvailable(st, segs, candOrder[pos]))
+        pos++;
+    if (pos == nOrder)
         return;
+    int candIdx = candOrder[pos];
 
-    // Compute potential coverage from current state plus all remaining available candidates.
-    bitset<MAX_CAND> potential = currCoverage;
-    for (int i = pos; i < nOrder; i++) {
-        int candIdx = candOrder[i];
-        if (!forbidden.test(candIdx))
-            potential |= candCoverage[candIdx];
+    // An idle thread gets the skip branch.
+    bool donated = false;
+    if (st.worker && depth < SPLIT_DEPTH && st.worker->pool->hungry()) {
+        Task task(st.trail.begin() + st.worker->rootMark, st.trail.end());
+        task.push_back(~candIdx);
+        st.worker->pool->push(*st.worker, move(task));
+        donated = true;
+        donations++;
     }
-    if (potential != fullCoverage)
+
+    // Place the candidate.
+    size_t mark = st.trail.size();
+    placeTurret(st, segs, candToOutposts, candIdx);
+    if (propagate(st, segs, outposts, candToOutposts))
+        dfs(pos + 1, depth + 1, st, segs, outposts, candToOutposts, candOrder, bound);
+    undoTo(st, segs, candToOutposts, mark);
+    if (bound.stop || donated)
         return;
 
-    // Try adding candidates from the ordered list.
-    for (int i = pos; i < nOrder; i++) {
-        int candIdx = candOrder[i];
-        if (forbidden.test(candIdx))
-            continue;
+    // Skip the candidate for the rest of this subtree.
+    forbidCandidate(st, segs, candIdx);
+    if (propagate(st, segs, outposts, candToOutposts))
+        dfs(pos + 1, depth + 1, st, segs, outposts, candToOutposts, candOrder, bound);
+}
 
-        bitset<MAX_CAND> newCoverage = currCoverage | candCoverage[candIdx];
-        bitset<MAX_CAND> newForbidden = forbidden;
-        newForbidden.set(candIdx);
-        newForbidden |= candConflict[candIdx]; // prevent conflicting placements
-
-        vector<int> newOutCount = outCount;
-        bool skipCandidate = false;
-        // Update outpost counts for outposts adjacent to candIdx.
-        for (int opIdx : candToOutposts[candIdx]) {
-            newOutCount[opIdx]++;
-            if (newOutCount[opIdx] > outposts[opIdx].req) {
-                skipCandidate = true;
-                break;
+// Sizes the table to opts.ttMb on the first call, whichever thread makes it.
+void TranspositionTable::allocate() {
+    call_once(allocated, [this]() { resize(opts.ttMb); });
+}
+
+void TranspositionTable::resize(int megabytes) {
+    size_t buckets = 0;
+    size_t bytes = (size_t)megabytes << 20;
+    // Largest power of two number of four-entry buckets that fits.
+    if (bytes >= 4 * sizeof(TTEntry)) {
+        buckets = 1;
+        while (buckets * 2 * 4 * sizeof(TTEntry) <= bytes)
+            buckets *= 2;
+    }
+    numEntries = buckets * 4;
+    entries.reset(numEntries ? new TTEntry[numEntries] : nullptr);
+    bucketMask = buckets - 1;
+}
+
+// A fresh generation; 0 is what empty entries hold, so it is skipped on wraparound.
+uint32_t TranspositionTable::newCase() {
+    uint32_t gen = ++lastGen;
+    while (gen == 0)
+        gen = ++lastGen;
+    return gen;
+}
+
+// The bound stored for key in generation gen, or INT_MIN if there is none.
+int TranspositionTable::probe(uint64_t key, uint32_t gen) const {
+    const TTEntry* bucket = &entries[(key & bucketMask) * 4];
+    for (int k = 0; k < 4; k++) {
+        uint64_t data = bucket[k].data.load(memory_order_relaxed);
+        uint64_t check = bucket[k].check.load(memory_order_relaxed);
+        if ((check ^ data) == key && uint32_t(data) == gen)
+            return (data >> 32) & 0xffffff;
+    }
+    return INT_MIN;
+}
+
+void TranspositionTable::store(uint64_t key, uint32_t gen, int bound, long long nodes) {
+    uint64_t work = 0;
+    while (nodes > 0) {
+        work++;
+        nodes >>= 1;
+    }
+    TTEntry* bucket = &entries[(key & bucketMask) * 4];
+    TTEntry* victim = nullptr;
+    bool victimStale = false;
+    uint64_t victimWork = 0;
+    for (int k = 0; k < 4; k++) {
+        TTEntry& e = bucket[k];
+        uint64_t data = e.data.load(memory_order_relaxed);
+        uint64_t check = e.check.load(memory_order_relaxed);
+        bool stale = uint32_t(data) != gen;
+        if (!stale && (check ^ data) == key) {
+            bound = max(bound, int((data >> 32) & 0xffffff));
+            work = max(work, data >> 56);
+            victim = &e;
+            break;
+        }
+        if (victim == nullptr || (stale && !victimStale) || (stale == victimStale && (data >> 56) < victimWork)) {
+            victim = &e;
+            victimStale = stale;
+            victimWork = data >> 56;
+        }
+    }
+    uint64_t data = gen | uint64_t(bound) << 32 | work << 56;
+    victim->data.store(data, memory_order_relaxed);
+    victim->check.store(key ^ data, memory_order_relaxed);
+}
+
+// Publishes a solution of count turrets, placed by the non-negative trail entries;
+// every thread's budget drops below it.
+void recordSolution(Bound& bound, int count, const vector<int>& trail) {
+    lock_guard<mutex> guard(bound.lock);
+    if (bound.found != -1 && bound.found <= count)
+        return;
+    bound.found = count;
+    bound.limit = count - 1;
+    bound.best.clear();
+    for (int entry : trail)
+        if (entry >= 0)
+            bound.best.push_back(entry);
+    if (opts.search == SEARCH_DEEPENING || bound.limit < bound.lowest)
+        bound.stop = true;
+}
+
+// Takes the calling thread's next batch of nodes from budget, the first of which is
+// the node asking, and reports whether the budget is used up.
+bool outOfBudget(Budget& budget) {
+    budgetLeft = 0;
+    if (budget.exhausted)
+        return true;
+    if (opts.timeLimitMs > 0 && chrono::steady_clock::now() >= budget.deadline) {
+        budget.exhausted = true;
+        return true;
+    }
+    long long batch = BUDGET_CHECK_NODES;
+    if (opts.nodeLimit > 0) {
+        long long taken = budget.nodes;
+        do {
+            // A share of what is left, so the other threads still get some.
+            long long left = opts.nodeLimit - taken;
+            batch = min<long long>(BUDGET_CHECK_NODES, max(left / opts.threads, min(left, 1LL)));
+            if (batch <= 0) {
+                budget.exhausted = true;
+                return true;
             }
+        } while (!budget.nodes.compare_exchange_weak(taken, taken + batch));
+    }
+    budgetLeft = batch - 1;
+    return false;
+}
+
+// Gives the nodes the calling thread took and did not run back to budget.
+void returnBudget(Budget& budget) {
+    budget.nodes -= budgetLeft;
+    budgetLeft = 0;
+}
+
+void addStats(SearchStats& into, const SearchStats& from) {
+    into.coverPrunes += from.coverPrunes;
+    into.overflowPrunes += from.overflowPrunes;
+    into.outpostPrunes += from.outpostPrunes;
+    into.boundPrunes += from.boundPrunes;
+    into.maxDepth = max(into.maxDepth, from.maxDepth);
+}
+
+bool anytimeMode() {
+    return opts.timeLimitMs > 0 || opts.nodeLimit > 0;
+}
+
+uint64_t splitmix64(uint64_t x) {
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+// The profile DP's answer as a Result, with its placement in the placement and
+// anytime modes. Returns false if the DP gave up.
+bool profileResult(int R, int C, const Grid& grid, Budget* budget, Result& dp) {
+    bool place = opts.printPlacement || anytimeMode();
+    int count = profileSolve(R, C, grid, place ? &dp.turrets : nullptr, budget);
+    if (count == PROFILE_GAVE_UP)
+        return false;
+    dp.count = count;
+    dp.lower = max(count, 0);
+    return true;
+}
+
+// Runs the DP cell by cell in row-major order over the grid turned so that it is at
+// most opts.profileWidth wide. Returns the minimum number of turrets, -1 if there is
+// no valid placement, or PROFILE_GAVE_UP if the profile maps hit opts.profileMb or
+// the deadline of budget passes (checked once a row).
+// With placement, the turrets of a cheapest final profile are read back without
+// keeping a parent per profile and step: the forward pass saves the whole map every
+// `every` steps, about the square root of their number, and the read-back replays
+// one stretch between two checkpoints at a time, last first, with parents kept just
+// for that stretch. Replays rebuild the maps exactly, used order included, so the
+// positions the parents refer to match. Memory stays near that of the maps, and a
+// placement costs one more pass; the maps themselves are capped as without it.
+int profileSolve(int R, int C, const Grid& grid, vector<Candidate>* placement, Budget* budget) {
+    STAT_TIMER(stats.searchMs);
+    int H = R, W = C;
+    vector<string> g(R);
+    for (int i = 0; i < R; i++)
+        g[i].assign(grid[i], C);
+    if (C > R) {
+        H = C;
+        W = R;
+        g.assign(H, string(W, '.'));
+        for (int i = 0; i < R; i++)
+            for (int j = 0; j < C; j++)
+                g[j][i] = grid[i][j];
+    }
+    vector<vector<int>> runStart(H, vector<int>(W));
+    for (int r = 0; r < H; r++)
+        for (int j = 0; j < W; j++)
+            runStart[r][j] = (j > 0 && g[r][j - 1] == '.') ? runStart[r][j - 1] : j;
+
+    // Two maps in flight, each at most half full, with four words per slot (the
+    // read-back also fills from).
+    size_t cap = ((size_t)opts.profileMb << 20) / (2 * (sizeof(uint64_t) + 3 * sizeof(int)));
+    ProfileMap cur, next;
+    cur.init(1024, cap, false);
+    next.init(1024, cap, false);
+    cur.relax(0, 0, 0); // every column and the row closed
+
+    // Row r has the steps r * (W + 1) + j for its cells and r * (W + 1) + W for its
+    // end. checkpoints[i] is the map before step i * every, as (key, cost) in used order.
+    int steps = H * (W + 1);
+    int every = max(1, (int)ceil(sqrt((double)steps)));
+    vector<vector<pair<uint64_t, int>>> checkpoints;
+    for (int s = 0; s < steps; s++) {
+        if (s % (W + 1) == 0 && budget && opts.timeLimitMs > 0 && chrono::steady_clock::now() >= budget->deadline) {
+            budget->exhausted = true;
+            return PROFILE_GAVE_UP;
+        }
+        if (placement && s % every == 0) {
+            checkpoints.emplace_back();
+            for (int slot : cur.used)
+                checkpoints.back().push_back({ cur.keys[slot], cur.cost[slot] });
+        }
+        if (!profileStep(g, runStart, W, s, cur, next))
+            return PROFILE_GAVE_UP;
+        swap(cur, next);
+    }
+
+    // ...and every column segment.
+    int best = INT_MAX;
+    size_t bestAt = 0;
+    for (size_t u = 0; u < cur.used.size(); u++) {
+        int slot = cur.used[u];
+        uint64_t key = cur.keys[slot];
+        bool ok = true;
+        for (int j = 0; j < W && ok; j++)
+            ok = profileAt(key, j) != COL_DARK && profileAt(key, j) != COL_NEED;
+        if (ok && cur.cost[slot] < best) {
+            best = cur.cost[slot];
+            bestAt = u;
         }
-        if (skipCandidate)
+    }
+    if (best == INT_MAX || !placement)
+        return best == INT_MAX ? -1 : best;
+
+    // bestAt is a position in the map after the last step; each stretch turns it into
+    // one in the map at its checkpoint, which is where the stretch before it ends.
+    placement->clear();
+    cur.init(1024, cap, true);
+    next.init(1024, cap, true);
+    vector<vector<int>> parents(every);
+    for (int first = (int)(checkpoints.size() - 1) * every; first >= 0; first -= every) {
+        cur.clear();
+        for (const pair<uint64_t, int>& entry : checkpoints[first / every])
+            cur.relax(entry.first, entry.second, 0);
+        int last = min(first + every, steps);
+        for (int s = first; s < last; s++) {
+            profileStep(g, runStart, W, s, cur, next);
+            swap(cur, next);
+            parents[s - first].clear();
+            for (int slot : cur.used)
+                parents[s - first].push_back(cur.from[slot]);
+        }
+        for (int s = last; s-- > first; ) {
+            int f = parents[s - first][bestAt];
+            int r = s / (W + 1), j = s % (W + 1);
+            if (f & 1)
+                placement->push_back(C > R ? Candidate{ j, r } : Candidate{ r, j });
+            bestAt = f >> 1;
+        }
+    }
+    return best;
+}
+
+// Step s of the DP, from cur into next: cell (r, j) of g for s = r * (W + 1) + j with
+// j < W, the end of row r for j == W. Returns false if next outgrows its cap.
+bool profileStep(const vector<string>& g, const vector<vector<int>>& runStart, int W, int s,
+    ProfileMap& cur, ProfileMap& next) {
+    int r = s / (W + 1), j = s % (W + 1);
+    next.clear();
+    if (j == W) {
+        // The border ends every row segment.
+        for (size_t u = 0; u < cur.used.size(); u++) {
+            int slot = cur.used[u];
+            uint64_t key = cur.keys[slot];
+            if (!closeRow(key, W, W, runStart[r][W - 1]))
+                continue;
+            if (!next.relax(withProfile(key, W, ROW_CLOSED), cur.cost[slot], 2 * u))
+                return false;
+        }
+        return true;
+    }
+
+    char ch = g[r][j];
+    for (size_t u = 0; u < cur.used.size(); u++) {
+        int slot = cur.used[u];
+        uint64_t key = cur.keys[slot];
+        int cost = cur.cost[slot];
+        int c = profileAt(key, j), h = profileAt(key, W);
+        bool colTurret = c == COL_TURRET_ABOVE || c == COL_TURRET;
+        bool rowTurret = h == ROW_TURRET_LEFT || h == ROW_TURRET;
+
+        if (ch != '.') {
+            // Both segments end here: dark cells must have been lit by now.
+            if (!closeRow(key, W, j, j > 0 ? runStart[r][j - 1] : 0))
+                continue;
+            if (c == COL_DARK || c == COL_NEED)
+                continue;
+            key = withProfile(key, j, COL_CLOSED);
+            int rowState = ROW_CLOSED;
+            if (ch != '#') {
+                int rem = (ch - '0') - (c == COL_TURRET_ABOVE) - (h == ROW_TURRET_LEFT);
+                if (rem < 0 || rem > 2)
+                    continue;
+                rowState = ROW_OUT0 + rem;
+            }
+            if (!next.relax(withProfile(key, W, rowState), cost, 2 * u))
+                return false;
             continue;
+        }
 
-        // For each outpost, check that it's still possible to meet its required count.
-        for (size_t opIdx = 0; opIdx < outposts.size(); opIdx++) {
-            int needed = outposts[opIdx].req - newOutCount[opIdx];
-            int possible = 0;
-            for (int cand : outposts[opIdx].adj) {
-                if (!newForbidden.test(cand))
-                    possible++;
+        for (int t = 0; t <= 1; t++) {
+            uint64_t k = key;
+            if (h >= ROW_OUT0 && h <= ROW_OUT2) {
+                // The outpost to the left gets t from this cell; what is left
+                // has to come from the cell below it.
+                int rem = (h - ROW_OUT0) - t;
+                if (rem < 0 || rem > 1)
+                    continue;
+                k = withProfile(k, j - 1, rem ? COL_NEED : COL_BLOCKED);
             }
-            if (possible < needed) {
-                skipCandidate = true;
-                break;
+            if (t == 1) {
+                if (colTurret || rowTurret || c == COL_BLOCKED)
+                    continue;
+                // The turret lights the row segment so far.
+                for (int jj = runStart[r][j]; jj < j; jj++)
+                    if (profileAt(k, jj) == COL_PENDING)
+                        k = withProfile(k, jj, COL_LIT);
+                k = withProfile(k, j, COL_TURRET_ABOVE);
+                k = withProfile(k, W, ROW_TURRET_LEFT);
+            } else {
+                if (c == COL_NEED)
+                    continue;
+                int col = colTurret ? COL_TURRET : c == COL_DARK ? COL_DARK : rowTurret ? COL_LIT : COL_PENDING;
+                k = withProfile(k, j, col);
+                k = withProfile(k, W, rowTurret ? ROW_TURRET : ROW_OPEN);
             }
+            if (!next.relax(k, cost + t, 2 * u + t))
+                return false;
         }
-        if (skipCandidate)
-            continue;
+    }
+    return true;
+}
 
-        dfs(i + 1, count + 1, newCoverage, newForbidden, newOutCount,
-            candCoverage, candConflict, outposts, candToOutposts, fullCoverage, candOrder, best, solutionFound);
-        if (solutionFound)
-            return;
+// State of column j, or of the row segment for j == W.
+int profileAt(uint64_t key, int j) {
+    return (key >> (3 * j)) & 7;
+}
+
+uint64_t withProfile(uint64_t key, int j, int state) {
+    return (key & ~(uint64_t(7) << (3 * j))) | uint64_t(state) << (3 * j);
+}
+
+// Ends the row segment left of column j, which started at runStart: cells still
+// pending on it turn dark, and an outpost just left of j gets nothing from the right.
+// Returns false if that leaves the outpost short.
+bool closeRow(uint64_t& key, int W, int j, int runStart) {
+    int h = profileAt(key, W);
+    if (h == ROW_OPEN) {
+        for (int jj = runStart; jj < j; jj++)
+            if (profileAt(key, jj) == COL_PENDING)
+                key = withProfile(key, jj, COL_DARK);
+    } else if (h >= ROW_OUT0 && h <= ROW_OUT2) {
+        if (h == ROW_OUT2)
+            return false;
+        key = withProfile(key, j - 1, h == ROW_OUT1 ? COL_NEED : COL_BLOCKED);
+    }
+    return true;
+}
+
+void ProfileMap::init(size_t slots, size_t cap, bool track) {
+    keys.assign(slots, EMPTY_PROFILE);
+    cost.assign(slots, 0);
+    from.assign(track ? slots : 0, 0);
+    used.clear();
+    maxSlots = max(cap, slots);
+}
+
+void ProfileMap::clear() {
+    for (int slot : used)
+        keys[slot] = EMPTY_PROFILE;
+    used.clear();
+}
+
+// Records key at cost c, reached by f, unless it is already there at most as cheap.
+// Grows the table to stay at most half full; returns false if that would exceed
+// maxSlots. Growing keeps the order of used, which the from entries refer to.
+bool ProfileMap::relax(uint64_t key, int c, int f) {
+    size_t mask = keys.size() - 1;
+    size_t slot = splitmix64(key) & mask;
+    while (keys[slot] != EMPTY_PROFILE && keys[slot] != key)
+        slot = (slot + 1) & mask;
+    if (keys[slot] == key) {
+        if (c < cost[slot]) {
+            cost[slot] = c;
+            if (!from.empty())
+                from[slot] = f;
+        }
+        return true;
+    }
+    if (2 * (used.size() + 1) > keys.size()) {
+        if (2 * keys.size() > maxSlots)
+            return false;
+        vector<uint64_t> oldKeys(2 * keys.size(), EMPTY_PROFILE);
+        vector<int> oldCost(2 * keys.size(), 0);
+        vector<int> oldFrom(from.empty() ? 0 : 2 * keys.size(), 0);
+        vector<int> oldUsed;
+        oldUsed.reserve(2 * used.size());
+        swap(keys, oldKeys);
+        swap(cost, oldCost);
+        swap(from, oldFrom);
+        swap(used, oldUsed);
+        for (int old : oldUsed)
+            relax(oldKeys[old], oldCost[old], oldFrom.empty() ? 0 : oldFrom[old]);
+        return relax(key, c, f);
     }
+    keys[slot] = key;
+    cost[slot] = c;
+    if (!from.empty())
+        from[slot] = f;
+    used.push_back(slot);
+    return true;
 }
@@ -0,0 +1,821 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <cctype>
+#include <climits>
+using namespace std;
+
+// CDCL SAT engine for the same problem as problemA.cpp. One boolean per '.' cell
+// says whether it holds a turret, and the rules become clauses:
+//  - every cell is lit: the OR of the turrets on its row and column segments;
+//  - at most one turret per segment (pairwise, or a sequential counter when long);
+//  - an outpost wanting k of its n <= 4 neighbours forbids every k + 1 of them
+//    together and every n - k + 1 of them missing together.
+// The turret count is minimised by repeated solving: a totalizer over the turret
+// variables gives "at least i turrets" outputs, and after each model with m
+// turrets the unit clause "not at least m" is added, until the formula is UNSAT.
+// Learnt clauses stay valid across the bounds, since the bound only tightens.
+// Cells that share no segment or outpost are independent, so each component gets
+// its own solver and its own totalizer.
+
+// Literals are 2 * var + sign; a negative literal has the low bit set.
+inline int posLit(int v) { return 2 * v; }
+inline int negLit(int v) { return 2 * v + 1; }
+
+const signed char VAL_FALSE = 0, VAL_TRUE = 1, VAL_UNDEF = 2;
+const int NO_REASON = -1;
+const int RESTART_UNIT = 100;      // conflicts per Luby step
+const int SEQ_COUNTER_FROM = 6;    // segments this long use a sequential counter
+const double VAR_DECAY = 0.95;
+
+struct Clause {
+    int start, size;       // literals are arena[start .. start + size - 1]
+    int lbd;               // distinct decision levels when learnt, 0 for input clauses
+    bool deleted;
+};
+
+struct Watch {
+    int clause;
+    int blocker;           // some other literal of the clause; if true, skip the clause
+};
+
+struct Solver {
+    int numVars = 0;
+    bool ok = true;                  // false once the formula is known UNSAT
+    vector<int> arena;
+    vector<Clause> clauses;
+    vector<vector<Watch>> watches;   // per literal, clauses watching it
+    int numLearnts = 0;
+    int maxLearnts = 2000;
+
+    vector<signed char> value;       // per variable
+    vector<int> level, reason;
+    vector<char> phase;              // saved polarity, 1 for true
+    vector<int> trail, trailLim;
+    int qhead = 0;
+
+    // VSIDS: binary max-heap of variables on activity.
+    vector<double> activity;
+    double varInc = 1.0;
+    vector<int> heap, heapPos;       // heapPos[v] == -1 when v is not in the heap
+
+    vector<char> seen;               // analyze scratch
+    vector<int> learnt;
+    vector<int> model;               // last satisfying assignment, per variable
+
+    int lubyIndex = 0;
+    long long conflicts = 0, decisions = 0;
+};
+
+// Cells of a case in row-major order, row i at data + i * C.
+struct Grid {
+    const char* data = nullptr;
+    int C = 0;
+
+    const char* operator[](int i) const { return data + (size_t)i * C; }
+};
+
+// stdin is read in blocks into inBuf and parsed from there, so the cells of a case
+// go straight into one array without a string per row.
+char inBuf[1 << 20];
+size_t inLen = 0, inPos = 0;
+
+struct Options {
+    bool printNodes = false;  // report conflicts and decisions per case on stderr
+};
+
+Options opts;
+long long conflictCount = 0, decisionCount = 0;
+
+int nextByte();
+int nextToken();
+int readInt();
+bool readGrid(int R, int C, vector<char>& cells);
+int solve(int R, int C, const Grid& grid);
+int minimizeComponent(const vector<vector<int>>& segs, const vector<pair<vector<int>, int>>& outposts,
+                      const vector<vector<int>>& lighting, int numVars);
+int newVar(Solver& s);
+void addClause(Solver& s, vector<int> lits);
+void atMostOne(Solver& s, const vector<int>& vars);
+void exactly(Solver& s, const vector<int>& vars, int k);
+vector<int> totalizer(Solver& s, const vector<int>& vars, int lo, int hi, int cap);
+bool solveSat(Solver& s);
+int litValue(const Solver& s, int lit);
+void enqueue(Solver& s, int lit, int from);
+int propagate(Solver& s);
+int analyze(Solver& s, int confl);
+bool redundant(Solver& s, int lit);
+void backtrack(Solver& s, int lvl);
+int attachClause(Solver& s, const vector<int>& lits, int lbd);
+void reduceDb(Solver& s);
+void bumpVar(Solver& s, int v);
+void heapInsert(Solver& s, int v);
+void heapUp(Solver& s, int i);
+void heapDown(Solver& s, int i);
+int heapPop(Solver& s);
+int luby(int i);
+
+int main(int argc, char** argv) {
+    ios::sync_with_stdio(false);
+    cin.tie(nullptr);
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--nodes") == 0)
+            opts.printNodes = true;
+        else {
+            cerr << "usage: " << argv[0] << " [--nodes] < input\n";
+            return 1;
+        }
+    }
+
+    int T = readInt();
+    vector<char> cells;
+    for (int k = 1; k <= T; k++) {
+        int R = readInt(), C = readInt();
+        if (!readGrid(R, C, cells)) {
+            cerr << "input ends before case " << k << "\n";
+            return 1;
+        }
+        Grid grid = { cells.data(), C };
+
+        conflictCount = decisionCount = 0;
+        int result = solve(R, C, grid);
+        if (opts.printNodes)
+            cerr << "conflicts: " << conflictCount << ", decisions: " << decisionCount << "\n";
+        if (result == -1)
+            cout << "noxus will rise!" << "\n";
+        else
+            cout << result << "\n";
+    }
+    return 0;
+}
+
+// Next input byte, or -1 at the end.
+int nextByte() {
+    if (inPos == inLen) {
+        inLen = fread(inBuf, 1, sizeof(inBuf), stdin);
+        inPos = 0;
+        if (inLen == 0)
+            return -1;
+    }
+    return (unsigned char)inBuf[inPos++];
+}
+
+// First byte after spaces and line ends, or -1 at the end.
+int nextToken() {
+    int ch = nextByte();
+    while (ch != -1 && ch <= ' ')
+        ch = nextByte();
+    return ch;
+}
+
+int readInt() {
+    int v = 0;
+    for (int ch = nextToken(); ch >= '0' && ch <= '9'; ch = nextByte())
+        v = v * 10 + (ch - '0');
+    return v;
+}
+
+// Rows of the case into cells; false if the input ends first or a row is not C
+// cells long.
+bool readGrid(int R, int C, vector<char>& cells) {
+    cells.resize((size_t)R * C);
+    for (int i = 0; i < R; i++) {
+        int ch = nextToken();
+        for (int j = 0; j < C; j++, ch = nextByte()) {
+            if (ch <= ' ')
+                return false;
+            cells[(size_t)i * C + j] = ch;
+        }
+        if (ch > ' ')
+            return false;
+    }
+    return true;
+}
+
+int findRoot(vector<int>& parent, int x) {
+    while (parent[x] != x)
+        x = parent[x] = parent[parent[x]];
+    return x;
+}
+
+// Returns the minimum number of turrets, or -1 if no valid placement exists.
+int solve(int R, int C, const Grid& grid) {
+    // As in problemA.cpp: an open grid takes one turret per line of its shorter side.
+    // Refuting one turret fewer is a pigeonhole proof, which resolution cannot do
+    // in polynomial size.
+    bool open = true;
+    for (int i = 0; i < R; i++)
+        for (int j = 0; j < C; j++)
+            if (grid[i][j] != '.')
+                open = false;
+    if (open)
+        return min(R, C);
+
+    vector<vector<int>> cellId(R, vector<int>(C, -1));
+    int numCells = 0;
+    for (int i = 0; i < R; i++)
+        for (int j = 0; j < C; j++)
+            if (grid[i][j] == '.')
+                cellId[i][j] = numCells++;
+
+    // Segments as lists of cells: rows first, then columns.
+    vector<int> rowSeg(numCells), colSeg(numCells);
+    vector<vector<int>> segCells;
+    for (int i = 0; i < R; i++) {
+        for (int j = 0; j < C; j++) {
+            if (grid[i][j] != '.')
+                continue;
+            if (j == 0 || grid[i][j - 1] != '.') {
+                rowSeg[cellId[i][j]] = segCells.size();
+                segCells.push_back(vector<int>());
+            } else
+                rowSeg[cellId[i][j]] = rowSeg[cellId[i][j - 1]];
+            segCells[rowSeg[cellId[i][j]]].push_back(cellId[i][j]);
+        }
+    }
+    for (int j = 0; j < C; j++) {
+        for (int i = 0; i < R; i++) {
+            if (grid[i][j] != '.')
+                continue;
+            if (i == 0 || grid[i - 1][j] != '.') {
+                colSeg[cellId[i][j]] = segCells.size();
+                segCells.push_back(vector<int>());
+            } else
+                colSeg[cellId[i][j]] = colSeg[cellId[i - 1][j]];
+            segCells[colSeg[cellId[i][j]]].push_back(cellId[i][j]);
+        }
+    }
+
+    // Outposts as (neighbour cells, requirement).
+    vector<pair<vector<int>, int>> outposts;
+    int dr[4] = { 0, 0, 1, -1 };
+    int dc[4] = { 1, -1, 0, 0 };
+    for (int i = 0; i < R; i++) {
+        for (int j = 0; j < C; j++) {
+            if (!isdigit(grid[i][j]))
+                continue;
+            vector<int> around;
+            for (int dir = 0; dir < 4; dir++) {
+                int ni = i + dr[dir], nj = j + dc[dir];
+                if (ni >= 0 && ni < R && nj >= 0 && nj < C && cellId[ni][nj] != -1)
+                    around.push_back(cellId[ni][nj]);
+            }
+            int req = grid[i][j] - '0';
+            if (req > (int)around.size())
+                return -1;
+            if (!around.empty())
+                outposts.push_back(make_pair(around, req));
+        }
+    }
+
+    // Components: cells sharing a segment or an outpost.
+    vector<int> parent(numCells);
+    for (int c = 0; c < numCells; c++)
+        parent[c] = c;
+    for (const vector<int>& seg : segCells)
+        for (int c : seg)
+            parent[findRoot(parent, c)] = findRoot(parent, seg[0]);
+    for (const auto& o : outposts)
+        for (int c : o.first)
+            parent[findRoot(parent, c)] = findRoot(parent, o.first[0]);
+
+    vector<int> compOf(numCells, -1), localId(numCells);
+    vector<vector<int>> compCells;
+    for (int c = 0; c < numCells; c++) {
+        int r = findRoot(parent, c);
+        if (compOf[r] == -1) {
+            compOf[r] = compCells.size();
+            compCells.push_back(vector<int>());
+        }
+        localId[c] = compCells[compOf[r]].size();
+        compCells[compOf[r]].push_back(c);
+    }
+
+    vector<vector<vector<int>>> compSegs(compCells.size());
+    vector<vector<pair<vector<int>, int>>> compOutposts(compCells.size());
+    vector<vector<vector<int>>> compLighting(compCells.size());
+    for (const vector<int>& seg : segCells) {
+        vector<int> local;
+        for (int c : seg)
+            local.push_back(localId[c]);
+        compSegs[compOf[findRoot(parent, seg[0])]].push_back(local);
+    }
+    for (const auto& o : outposts) {
+        vector<int> local;
+        for (int c : o.first)
+            local.push_back(localId[c]);
+        compOutposts[compOf[findRoot(parent, o.first[0])]].push_back(make_pair(local, o.second));
+    }
+    for (int c = 0; c < numCells; c++) {
+        vector<int> coverers;
+        for (int other : segCells[rowSeg[c]])
+            coverers.push_back(localId[other]);
+        for (int other : segCells[colSeg[c]])
+            if (other != c)
+                coverers.push_back(localId[other]);
+        compLighting[compOf[findRoot(parent, c)]].push_back(coverers);
+    }
+
+    int total = 0;
+    for (size_t k = 0; k < compCells.size(); k++) {
+        int best = minimizeComponent(compSegs[k], compOutposts[k], compLighting[k], compCells[k].size());
+        if (best == -1)
+            return -1;
+        total += best;
+    }
+    return total;
+}
+
+// Minimum turrets over one component whose cells are variables 0 .. numVars - 1,
+// or -1 if it has no valid placement.
+int minimizeComponent(const vector<vector<int>>& segs, const vector<pair<vector<int>, int>>& outposts,
+                      const vector<vector<int>>& lighting, int numVars) {
+    Solver s;
+    for (int v = 0; v < numVars; v++)
+        newVar(s);
+    for (const vector<int>& cover : lighting) {
+        vector<int> lits;
+        for (int v : cover)
+            lits.push_back(posLit(v));
+        addClause(s, lits);
+    }
+    for (const vector<int>& seg : segs)
+        atMostOne(s, seg);
+    for (const auto& o : outposts)
+        exactly(s, o.first, o.second);
+
+    int best = -1;
+    vector<int> atLeast;    // atLeast[i]: at least i + 1 turrets
+    while (solveSat(s)) {
+        int count = 0;
+        for (int v = 0; v < numVars; v++)
+            count += s.model[v];
+        best = count;
+        if (count == 0)
+            break;
+        if (atLeast.empty()) {
+            vector<int> vars(numVars);
+            for (int v = 0; v < numVars; v++)
+                vars[v] = v;
+            atLeast = totalizer(s, vars, 0, numVars, count);
+        }
+        addClause(s, { negLit(atLeast[count - 1]) });
+    }
+    conflictCount += s.conflicts;
+    decisionCount += s.decisions;
+    return best;
+}
+
+int newVar(Solver& s) {
+    int v = s.numVars++;
+    s.value.push_back(VAL_UNDEF);
+    s.level.push_back(0);
+    s.reason.push_back(NO_REASON);
+    s.phase.push_back(0);
+    s.activity.push_back(0.0);
+    s.heapPos.push_back(-1);
+    s.seen.resize(s.numVars + 1);    // also indexed by decision level for LBD
+    s.watches.resize(2 * s.numVars);
+    heapInsert(s, v);
+    return v;
+}
+
+// Adds an input clause; only called at decision level 0.
+void addClause(Solver& s, vector<int> lits) {
+    if (!s.ok)
+        return;
+    sort(lits.begin(), lits.end());
+    size_t j = 0;
+    for (size_t i = 0; i < lits.size(); i++) {
+        int val = litValue(s, lits[i]);
+        if (val == VAL_TRUE || (i > 0 && lits[i] == (lits[i - 1] ^ 1)))
+            return;
+        if (val == VAL_FALSE || (j > 0 && lits[i] == lits[j - 1]))
+            continue;
+        lits[j++] = lits[i];
+    }
+    lits.resize(j);
+    if (lits.empty())
+        s.ok = false;
+    else if (lits.size() == 1) {
+        enqueue(s, lits[0], NO_REASON);
+        if (propagate(s) != -1)
+            s.ok = false;
+    } else
+        attachClause(s, lits, 0);
+}
+
+void atMostOne(Solver& s, const vector<int>& vars) {
+    int n = vars.size();
+    if (n < SEQ_COUNTER_FROM) {
+        for (int a = 0; a < n; a++)
+            for (int b = a + 1; b < n; b++)
+                addClause(s, { negLit(vars[a]), negLit(vars[b]) });
+        return;
+    }
+    // Sequential counter: prefix[i] says some of vars[0 .. i] is set.
+    int prev = -1;
+    for (int i = 0; i < n; i++) {
+        if (prev != -1)
+            addClause(s, { negLit(prev), negLit(vars[i]) });
+        if (i == n - 1)
+            break;
+        int prefix = newVar(s);
+        addClause(s, { negLit(vars[i]), posLit(prefix) });
+        if (prev != -1)
+            addClause(s, { negLit(prev), posLit(prefix) });
+        prev = prefix;
+    }
+}
+
+// Exactly k of vars (at most four of them): every k + 1 of them can't all be set,
+// and every n - k + 1 of them can't all be clear.
+void exactly(Solver& s, const vector<int>& vars, int k) {
+    int n = vars.size();
+    for (int mask = 0; mask < (1 << n); mask++) {
+        int bits = __builtin_popcount(mask);
+        vector<int> someClear, someSet;
+        for (int i = 0; i < n; i++) {
+            if (mask >> i & 1) {
+                someClear.push_back(negLit(vars[i]));
+                someSet.push_back(posLit(vars[i]));
+            }
+        }
+        if (bits == k + 1)
+            addClause(s, someClear);
+        if (bits == n - k + 1)
+            addClause(s, someSet);
+    }
+}
+
+// Totalizer over vars[lo .. hi - 1]: returns out with out[i] implied by
+// "at least i + 1 of them are set", keeping only the first cap outputs.
+vector<int> totalizer(Solver& s, const vector<int>& vars, int lo, int hi, int cap) {
+    if (hi - lo == 1)
+        return { vars[lo] };
+    int mid = (lo + hi) / 2;
+    vector<int> left = totalizer(s, vars, lo, mid, cap);
+    vector<int> right = totalizer(s, vars, mid, hi, cap);
+    int size = min((int)(left.size() + right.size()), cap);
+    vector<int> out(size);
+    for (int i = 0; i < size; i++)
+        out[i] = newVar(s);
+    for (int a = 0; a <= (int)left.size(); a++) {
+        for (int b = 0; b <= (int)right.size(); b++) {
+            if (a + b == 0 || a + b > size)
+                continue;
+            vector<int> lits;
+            if (a > 0)
+                lits.push_back(negLit(left[a - 1]));
+            if (b > 0)
+                lits.push_back(negLit(right[b - 1]));
+            lits.push_back(posLit(out[a + b - 1]));
+            addClause(s, lits);
+        }
+    }
+    return out;
+}
+
+int litValue(const Solver& s, int lit) {
+    signed char v = s.value[lit >> 1];
+    return v == VAL_UNDEF ? VAL_UNDEF : v ^ (lit & 1);
+}
+
+void enqueue(Solver& s, int lit, int from) {
+    int v = lit >> 1;
+    s.value[v] = (lit & 1) ? VAL_FALSE : VAL_TRUE;
+    s.level[v] = s.trailLim.size();
+    s.reason[v] = from;
+    s.trail.push_back(lit);
+}
+
+// Unit propagation over the two watched literals of each clause, which sit at
+// positions 0 and 1. Returns a conflicting clause, or -1.
+int propagate(Solver& s) {
+    while (s.qhead < (int)s.trail.size()) {
+        int falseLit = s.trail[s.qhead++] ^ 1;
+        vector<Watch>& ws = s.watches[falseLit];
+        size_t i = 0, j = 0;
+        while (i < ws.size()) {
+            Watch w = ws[i++];
+            if (litValue(s, w.blocker) == VAL_TRUE) {
+                ws[j++] = w;
+                continue;
+            }
+            Clause& c = s.clauses[w.clause];
+            int* lits = &s.arena[c.start];
+            if (lits[0] == falseLit)
+                swap(lits[0], lits[1]);
+            int first = lits[0];
+            w.blocker = first;
+            if (litValue(s, first) == VAL_TRUE) {
+                ws[j++] = w;
+                continue;
+            }
+            bool moved = false;
+            for (int k = 2; k < c.size; k++) {
+                if (litValue(s, lits[k]) != VAL_FALSE) {
+                    swap(lits[1], lits[k]);
+                    s.watches[lits[1]].push_back(w);
+                    moved = true;
+                    break;
+                }
+            }
+            if (moved)
+                continue;
+            ws[j++] = w;
+            if (litValue(s, first) == VAL_FALSE) {
+                while (i < ws.size())
+                    ws[j++] = ws[i++];
+                ws.resize(j);
+                s.qhead = s.trail.size();
+                return w.clause;
+            }
+            enqueue(s, first, w.clause);
+        }
+        ws.resize(j);
+    }
+    return -1;
+}
+
+// First-UIP learning: fills s.learnt with the asserting literal first and the
+// literal of the backjump level second, and returns that level.
+int analyze(Solver& s, int confl) {
+    int current = s.trailLim.size();
+    s.learnt.assign(1, 0);
+    int pathCount = 0, p = -1;
+    int idx = s.trail.size() - 1;
+    do {
+        const Clause& c = s.clauses[confl];
+        for (int k = (p == -1 ? 0 : 1); k < c.size; k++) {
+            int q = s.arena[c.start + k];
+            int v = q >> 1;
+            if (s.seen[v] || s.level[v] == 0)
+                continue;
+            bumpVar(s, v);
+            s.seen[v] = 1;
+            if (s.level[v] >= current)
+                pathCount++;
+            else
+                s.learnt.push_back(q);
+        }
+        while (!s.seen[s.trail[idx] >> 1])
+            idx--;
+        p = s.trail[idx--];
+        confl = s.reason[p >> 1];
+        s.seen[p >> 1] = 0;
+        pathCount--;
+    } while (pathCount > 0);
+    s.learnt[0] = p ^ 1;
+
+    // Drop literals implied by the rest of the clause through their own reason.
+    vector<int> all(s.learnt.begin() + 1, s.learnt.end());
+    size_t j = 1;
+    for (size_t i = 1; i < s.learnt.size(); i++)
+        if (!redundant(s, s.learnt[i]))
+            s.learnt[j++] = s.learnt[i];
+    s.learnt.resize(j);
+    for (int q : all)
+        s.seen[q >> 1] = 0;
+
+    int back = 0;
+    for (size_t i = 1; i < s.learnt.size(); i++) {
+        if (s.level[s.learnt[i] >> 1] > back) {
+            back = s.level[s.learnt[i] >> 1];
+            swap(s.learnt[1], s.learnt[i]);
+        }
+    }
+    return back;
+}
+
+bool redundant(Solver& s, int lit) {
+    int from = s.reason[lit >> 1];
+    if (from == NO_REASON)
+        return false;
+    const Clause& c = s.clauses[from];
+    for (int k = 1; k < c.size; k++) {
+        int v = s.arena[c.start + k] >> 1;
+        if (!s.seen[v] && s.level[v] > 0)
+            return false;
+    }
+    return true;
+}
+
+void backtrack(Solver& s, int lvl) {
+    if ((int)s.trailLim.size() <= lvl)
+        return;
+    for (int i = s.trail.size() - 1; i >= s.trailLim[lvl]; i--) {
+        int v = s.trail[i] >> 1;
+        s.phase[v] = s.value[v] == VAL_TRUE;
+        s.value[v] = VAL_UNDEF;
+        s.reason[v] = NO_REASON;
+        heapInsert(s, v);
+    }
+    s.trail.resize(s.trailLim[lvl]);
+    s.trailLim.resize(lvl);
+    s.qhead = s.trail.size();
+}
+
+int attachClause(Solver& s, const vector<int>& lits, int lbd) {
+    Clause c;
+    c.start = s.arena.size();
+    c.size = lits.size();
+    c.lbd = lbd;
+    c.deleted = false;
+    s.arena.insert(s.arena.end(), lits.begin(), lits.end());
+    int id = s.clauses.size();
+    s.clauses.push_back(c);
+    s.watches[lits[0]].push_back({ id, lits[1] });
+    s.watches[lits[1]].push_back({ id, lits[0] });
+    if (lbd > 0)
+        s.numLearnts++;
+    return id;
+}
+
+// Deletes the worse half of the learnt clauses by LBD, keeping glue clauses
+// (LBD <= 2), then rebuilds arena and watches without clauses satisfied at
+// level 0 and without literals false there. Only called at level 0, where no
+// reason is looked at again.
+void reduceDb(Solver& s) {
+    vector<int> learnts;
+    for (int i = 0; i < (int)s.clauses.size(); i++)
+        if (s.clauses[i].lbd > 2)
+            learnts.push_back(i);
+    sort(learnts.begin(), learnts.end(), [&](int a, int b) { return s.clauses[a].lbd > s.clauses[b].lbd; });
+    for (size_t i = 0; i < learnts.size() / 2; i++)
+        s.clauses[learnts[i]].deleted = true;
+
+    vector<int> oldArena;
+    vector<Clause> oldClauses;
+    oldArena.swap(s.arena);
+    oldClauses.swap(s.clauses);
+    for (vector<Watch>& ws : s.watches)
+        ws.clear();
+    s.numLearnts = 0;
+    vector<int> lits;
+    for (const Clause& c : oldClauses) {
+        if (c.deleted)
+            continue;
+        lits.clear();
+        bool satisfied = false;
+        for (int k = 0; k < c.size; k++) {
+            int l = oldArena[c.start + k];
+            int val = litValue(s, l);
+            if (val == VAL_TRUE)
+                satisfied = true;
+            else if (val == VAL_UNDEF)
+                lits.push_back(l);
+        }
+        if (!satisfied)
+            attachClause(s, lits, c.lbd);
+    }
+    for (int lit : s.trail)
+        s.reason[lit >> 1] = NO_REASON;
+}
+
+// Returns true with s.model filled in, or false once the formula is UNSAT.
+bool solveSat(Solver& s) {
+    if (!s.ok)
+        return false;
+    int budget = luby(s.lubyIndex++) * RESTART_UNIT;
+    for (;;) {
+        int confl = propagate(s);
+        if (confl != -1) {
+            s.conflicts++;
+            budget--;
+            if (s.trailLim.empty()) {
+                s.ok = false;
+                return false;
+            }
+            int back = analyze(s, confl);
+            backtrack(s, back);
+            if (s.learnt.size() == 1)
+                enqueue(s, s.learnt[0], NO_REASON);
+            else {
+                int lbd = 0;
+                for (int lit : s.learnt) {
+                    int lvl = s.level[lit >> 1];
+                    if (!s.seen[lvl]) {
+                        s.seen[lvl] = 1;
+                        lbd++;
+                    }
+                }
+                for (int lit : s.learnt)
+                    s.seen[s.level[lit >> 1]] = 0;
+                enqueue(s, s.learnt[0], attachClause(s, s.learnt, max(lbd, 1)));
+            }
+            s.varInc /= VAR_DECAY;
+            continue;
+        }
+        if (budget <= 0) {
+            backtrack(s, 0);
+            if (s.numLearnts > s.maxLearnts) {
+                reduceDb(s);
+                s.maxLearnts += s.maxLearnts / 10;
+            }
+            budget = luby(s.lubyIndex++) * RESTART_UNIT;
+            continue;
+        }
+        int v = -1;
+        while (!s.heap.empty()) {
+            v = heapPop(s);
+            if (s.value[v] == VAL_UNDEF)
+                break;
+            v = -1;
+        }
+        if (v == -1) {
+            s.model.assign(s.numVars, 0);
+            for (int u = 0; u < s.numVars; u++)
+                s.model[u] = s.value[u] == VAL_TRUE;
+            backtrack(s, 0);
+            return true;
+        }
+        s.decisions++;
+        s.trailLim.push_back(s.trail.size());
+        enqueue(s, s.phase[v] ? posLit(v) : negLit(v), NO_REASON);
+    }
+}
+
+void bumpVar(Solver& s, int v) {
+    s.activity[v] += s.varInc;
+    if (s.activity[v] > 1e100) {
+        for (double& a : s.activity)
+            a *= 1e-100;
+        s.varInc *= 1e-100;
+    }
+    if (s.heapPos[v] != -1)
+        heapUp(s, s.heapPos[v]);
+}
+
+void heapInsert(Solver& s, int v) {
+    if (s.heapPos[v] != -1)
+        return;
+    s.heapPos[v] = s.heap.size();
+    s.heap.push_back(v);
+    heapUp(s, s.heap.size() - 1);
+}
+
+void heapUp(Solver& s, int i) {
+    int v = s.heap[i];
+    while (i > 0) {
+        int up = (i - 1) / 2;
+        if (s.activity[s.heap[up]] >= s.activity[v])
+            break;
+        s.heap[i] = s.heap[up];
+        s.heapPos[s.heap[i]] = i;
+        i = up;
+    }
+    s.heap[i] = v;
+    s.heapPos[v] = i;
+}
+
+void heapDown(Solver& s, int i) {
+    int v = s.heap[i];
+    int n = s.heap.size();
+    for (;;) {
+        int child = 2 * i + 1;
+        if (child >= n)
+            break;
+        if (child + 1 < n && s.activity[s.heap[child + 1]] > s.activity[s.heap[child]])
+            child++;
+        if (s.activity[s.heap[child]] <= s.activity[v])
+            break;
+        s.heap[i] = s.heap[child];
+        s.heapPos[s.heap[i]] = i;
+        i = child;
+    }
+    s.heap[i] = v;
+    s.heapPos[v] = i;
+}
+
+int heapPop(Solver& s) {
+    int v = s.heap[0];
+    s.heapPos[v] = -1;
+    int last = s.heap.back();
+    s.heap.pop_back();
+    if (!s.heap.empty()) {
+        s.heap[0] = last;
+        s.heapPos[last] = 0;
+        heapDown(s, 0);
+    }
+    return v;
+}
+
+// Luby restart sequence 1, 1, 2, 1, 1, 2, 4, ...
+int luby(int i) {
+    int size = 1, seq = 0;
+    while (size < i + 1) {
+        seq++;
+        size = 2 * size + 1;
+    }
+    while (size - 1 != i) {
+        size = (size - 1) >> 1;
+        seq--;
+        i = i % size;
+    }
+    return 1 << seq;
+}
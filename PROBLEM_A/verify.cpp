@@ -0,0 +1,254 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cctype>
+using namespace std;
+
+// Independent checker for solver output in placement mode (problemA.cpp and Claude.cpp
+// with --placement, or problemA.cpp's anytime mode). For every case of the input it
+// reads the answer line and, unless there is no placement, the grid that follows it,
+// and checks with the rules of Claude.cpp's allCellsCovered/outpostsSatisfied that
+//  - the grid is the input with some '.' cells turned into 'T', as many as the answer;
+//  - every '.' is lit: a turret lights its row and column up to the next wall, outpost
+//    or border;
+//  - no turret lights another;
+//  - every outpost has exactly its digit of turrets next to it.
+// Each check is one sweep of the grid, so a case costs O(R*C). Answers can also be
+// compared with a file of expected ones, one per line like the solvers print them.
+// Both files are read whole and parsed in place, so batches of millions of cases
+// are bound by the disk.
+
+// A whole file in memory with a cursor.
+struct Text {
+    vector<char> buf;
+    size_t pos = 0;
+
+    bool load(const char* path);
+    bool done();
+    long long number();
+    bool line(const char*& s, size_t& n);
+    bool word(const char*& s, size_t& n);
+};
+
+bool isBlocked(char ch);
+const char* checkCase(int R, int C, const vector<const char*>& grid, long long answer,
+    const vector<const char*>& rows, int& badR, int& badC);
+
+int main(int argc, char** argv) {
+    if (argc < 3 || argc > 4) {
+        cerr << "usage: " << argv[0] << " input output [expected]\n";
+        return 2;
+    }
+    Text in, out, expected;
+    if (!in.load(argv[1]) || !out.load(argv[2]) || (argc == 4 && !expected.load(argv[3]))) {
+        cerr << "cannot read " << (argc == 4 ? "input, output or expected" : "input or output") << "\n";
+        return 2;
+    }
+
+    long long T = in.number();
+    long long failed = 0;
+    vector<const char*> grid, rows;
+    for (long long k = 1; k <= T; k++) {
+        int R = in.number(), C = in.number();
+        grid.assign(R, nullptr);
+        for (int i = 0; i < R; i++) {
+            const char* s;
+            size_t n;
+            if (!in.word(s, n) || (int)n != C) {
+                cerr << "input ends or is malformed in case " << k << "\n";
+                return 2;
+            }
+            grid[i] = s;
+        }
+
+        const char* reason = nullptr;
+        int badR = -1, badC = -1;
+        const char* s;
+        size_t n;
+        if (!out.line(s, n)) {
+            cout << "case " << k << ": output ends here\n";
+            failed += T - k + 1;
+            break;
+        }
+        // "noxus will rise!" and "unknown ..." come without a grid; anything else
+        // starts with the turret count.
+        long long answer = -1;
+        if (n > 0 && isdigit((unsigned char)s[0])) {
+            answer = strtoll(s, nullptr, 10);
+            rows.assign(R, nullptr);
+            for (int i = 0; i < R && !reason; i++) {
+                const char* row;
+                size_t len;
+                if (!out.line(row, len) || (int)len != C)
+                    reason = "grid row missing or of the wrong length";
+                else
+                    rows[i] = row;
+            }
+            if (!reason)
+                reason = checkCase(R, C, grid, answer, rows, badR, badC);
+        } else if (!(n >= 5 && strncmp(s, "noxus", 5) == 0) && !(n >= 7 && strncmp(s, "unknown", 7) == 0))
+            reason = "unreadable answer line";
+
+        if (!reason && expected.buf.size()) {
+            const char* e;
+            size_t m;
+            if (!expected.line(e, m))
+                reason = "no expected answer left";
+            else {
+                long long want = m > 0 && isdigit((unsigned char)e[0]) ? strtoll(e, nullptr, 10) : -1;
+                if (want != answer)
+                    reason = "answer differs from the expected one";
+            }
+        }
+
+        if (reason) {
+            failed++;
+            cout << "case " << k << ": " << reason;
+            if (badR != -1)
+                cout << " at (" << badR << ", " << badC << ")";
+            cout << "\n";
+        }
+    }
+    cout << T << " cases, " << failed << " failed\n";
+    return failed ? 1 : 0;
+}
+
+bool isBlocked(char ch) {
+    return ch == '#' || (ch >= '0' && ch <= '4');
+}
+
+// Returns why the placement in rows is not a valid one of answer turrets for grid,
+// with the offending cell in badR/badC, or nullptr if it is.
+const char* checkCase(int R, int C, const vector<const char*>& grid, long long answer,
+    const vector<const char*>& rows, int& badR, int& badC) {
+    long long turrets = 0;
+    for (int i = 0; i < R; i++) {
+        for (int j = 0; j < C; j++) {
+            char want = grid[i][j], got = rows[i][j];
+            if (got != want && !(got == 'T' && want == '.')) {
+                badR = i, badC = j;
+                return "grid differs from the input";
+            }
+            turrets += got == 'T';
+        }
+    }
+    if (turrets != answer)
+        return "turret count differs from the answer";
+
+    // lit[i * C + j]: (i, j) shares a row or column run with a turret. Each run is
+    // walked once per direction: count its turrets, then mark it if it has one.
+    vector<char> lit(R * C, 0);
+    for (int i = 0; i < R; i++) {
+        for (int j = 0; j < C; ) {
+            if (isBlocked(rows[i][j])) {
+                j++;
+                continue;
+            }
+            int start = j, inRun = 0;
+            for (; j < C && !isBlocked(rows[i][j]); j++)
+                inRun += rows[i][j] == 'T';
+            if (inRun > 1) {
+                badR = i, badC = start;
+                return "two turrets share a row run";
+            }
+            if (inRun)
+                memset(&lit[i * C + start], 1, j - start);
+        }
+    }
+    for (int j = 0; j < C; j++) {
+        for (int i = 0; i < R; ) {
+            if (isBlocked(rows[i][j])) {
+                i++;
+                continue;
+            }
+            int start = i, inRun = 0;
+            for (; i < R && !isBlocked(rows[i][j]); i++)
+                inRun += rows[i][j] == 'T';
+            if (inRun > 1) {
+                badR = start, badC = j;
+                return "two turrets share a column run";
+            }
+            if (inRun)
+                for (int r = start; r < i; r++)
+                    lit[r * C + j] = 1;
+        }
+    }
+
+    for (int i = 0; i < R; i++) {
+        for (int j = 0; j < C; j++) {
+            char ch = rows[i][j];
+            if (ch == '.' && !lit[i * C + j]) {
+                badR = i, badC = j;
+                return "cell not lit";
+            }
+            if (ch >= '0' && ch <= '4') {
+                int adjacent = (i > 0 && rows[i - 1][j] == 'T') + (i + 1 < R && rows[i + 1][j] == 'T')
+                    + (j > 0 && rows[i][j - 1] == 'T') + (j + 1 < C && rows[i][j + 1] == 'T');
+                if (adjacent != ch - '0') {
+                    badR = i, badC = j;
+                    return "outpost with the wrong number of turrets";
+                }
+            }
+        }
+    }
+    return nullptr;
+}
+
+bool Text::load(const char* path) {
+    FILE* f = fopen(path, "rb");
+    if (!f)
+        return false;
+    char chunk[1 << 16];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), f)) > 0)
+        buf.insert(buf.end(), chunk, chunk + n);
+    fclose(f);
+    buf.push_back('\0');
+    return true;
+}
+
+bool Text::done() {
+    return pos + 1 >= buf.size();
+}
+
+long long Text::number() {
+    while (!done() && isspace((unsigned char)buf[pos]))
+        pos++;
+    char* end;
+    long long v = strtoll(&buf[pos], &end, 10);
+    pos = end - buf.data();
+    return v;
+}
+
+// Next line without its end of line ('\r' included).
+bool Text::line(const char*& s, size_t& n) {
+    if (done())
+        return false;
+    size_t start = pos;
+    while (buf[pos] != '\n' && buf[pos] != '\0')
+        pos++;
+    size_t end = pos;
+    if (buf[pos] == '\n')
+        pos++;
+    if (end > start && buf[end - 1] == '\r')
+        end--;
+    s = &buf[start];
+    n = end - start;
+    return true;
+}
+
+bool Text::word(const char*& s, size_t& n) {
+    while (!done() && isspace((unsigned char)buf[pos]))
+        pos++;
+    if (done())
+        return false;
+    size_t start = pos;
+    while (buf[pos] != '\0' && !isspace((unsigned char)buf[pos]))
+        pos++;
+    s = &buf[start];
+    n = pos - start;
+    return true;
+}
@@ -1,136 +1,167 @@
 #include <iostream>
 #include <vector>
+#include <string>
 #include <algorithm>
+#include <cstdint>
+#include <cstdio>
 
 using namespace std;
 
 // ------------------------
 // Global constants and arrays
 // ------------------------
-const int MAX_N = 15;
 const int INF = 1e9;
 
-struct Position {
-    int r, c;
+struct Outpost {
+    int p, req;
 };
 
-int R, C, minTurrets;
-vector<string> grid;
-vector<vector<bool>> covered;
-vector<Position> outposts;
-vector<vector<int>> requiredTurrets;
+// The board is one flat array of (R + 2) x W cells, W = C + 2, with a '#' border
+// around the grid: cell (r, c) is at (r + 1) * W + c + 1, and a ray stops at the
+// border like at any wall, so walking it needs no bounds checks.
+// Coverage and turrets are bitsets over the same positions, changed in place; every
+// cell a turret newly covers goes on the trail, so a placement is undone by clearing
+// the trail back to its mark instead of copying the boards per branch.
+int R, C, W, minTurrets;
+vector<char> board;
+vector<uint64_t> covered, placed, emptyCells;
+vector<int> trail;   // sized to the board: a cell is on it at most once
+int trailTop;
+vector<Outpost> outposts;
+
+// Steps (Left, Up, Right, Down) on the padded board
+int step[4];
+
+// stdin is read in blocks into inBuf, and cells go from there straight onto the board.
+char inBuf[1 << 20];
+size_t inLen = 0, inPos = 0;
+
+bool test(const vector<uint64_t>& bits, int p) {
+    return (bits[p >> 6] >> (p & 63)) & 1;
+}
 
-// Directions (Left, Up, Right, Down)
-int dr[] = { 0, -1, 0, 1 };
-int dc[] = { -1, 0, 1, 0 };
+void setBit(vector<uint64_t>& bits, int p) {
+    bits[p >> 6] |= uint64_t(1) << (p & 63);
+}
 
+void clearBit(vector<uint64_t>& bits, int p) {
+    bits[p >> 6] &= ~(uint64_t(1) << (p & 63));
+}
 
 // ------------------------
-// Utility function to check if position is within grid bounds.
+// Next input byte, or -1 at the end.
 // ------------------------
-bool isValid(int r, int c) {
-    return r >= 0 && r < R && c >= 0 && c < C;
+int nextByte() {
+    if (inPos == inLen) {
+        inLen = fread(inBuf, 1, sizeof(inBuf), stdin);
+        inPos = 0;
+        if (inLen == 0)
+            return -1;
+    }
+    return (unsigned char)inBuf[inPos++];
 }
 
 // ------------------------
-// Function to mark turret coverage starting at (r, c).
+// First byte after spaces and line ends, or -1 at the end.
 // ------------------------
-void placeTurret(int r, int c, vector<vector<bool>>& tempCovered) {
-    tempCovered[r][c] = true;
-    for (int d = 0; d < 4; d++) {
-        int nr = r, nc = c;
-        while (true) {
-            nr += dr[d];
-            nc += dc[d];
-            if (!isValid(nr, nc) || grid[nr][nc] == '#' || (grid[nr][nc] >= '0' && grid[nr][nc] <= '4'))
-                break; // Stop at walls or outposts
-            tempCovered[nr][nc] = true;
-        }
-    }
+int nextToken() {
+    int ch = nextByte();
+    while (ch != -1 && ch <= ' ')
+        ch = nextByte();
+    return ch;
+}
+
+int readInt() {
+    int v = 0;
+    for (int ch = nextToken(); ch >= '0' && ch <= '9'; ch = nextByte())
+        v = v * 10 + (ch - '0');
+    return v;
 }
 
 // ------------------------
-// Checks if all empty cells are covered.
+// Function to mark turret coverage from p; rays stop at walls, outposts and the border.
 // ------------------------
-bool allCovered(const vector<vector<bool>>& tempCovered) {
-    for (int r = 0; r < R; r++) {
-        for (int c = 0; c < C; c++) {
-            if (grid[r][c] == '.' && !tempCovered[r][c])
-                return false;
-        }
+void cover(int p) {
+    if (!test(covered, p)) {
+        setBit(covered, p);
+        trail[trailTop++] = p;
     }
-    return true;
+}
+
+void placeTurret(int p) {
+    setBit(placed, p);
+    cover(p);
+    for (int d = 0; d < 4; d++)
+        for (int q = p + step[d]; board[q] == '.'; q += step[d])
+            cover(q);
 }
 
 // ------------------------
-// Checks if outpost turret requirements are met.
+// Takes back the turret at p and the coverage it added after mark.
 // ------------------------
-bool validOutpostPlacement(const vector<vector<int>>& placedTurrets) {
-    for (size_t i = 0; i < outposts.size(); i++) {
-        int r = outposts[i].r;
-        int c = outposts[i].c;
-        int count = 0;
-        for (int d = 0; d < 4; d++) {
-            int nr = r + dr[d], nc = c + dc[d];
-            if (isValid(nr, nc) && placedTurrets[nr][nc])
-                count++;
-        }
-        if (count != requiredTurrets[r][c])
+void removeTurret(int p, int mark) {
+    clearBit(placed, p);
+    while (trailTop > mark)
+        clearBit(covered, trail[--trailTop]);
+}
+
+// ------------------------
+// Checks if all empty cells are covered.
+// ------------------------
+bool allCovered() {
+    for (size_t i = 0; i < emptyCells.size(); i++) {
+        if (emptyCells[i] & ~covered[i])
             return false;
     }
     return true;
 }
 
 // ------------------------
-// Checks if placing a turret at (r, c) would conflict with any turret already placed.
-// Two turrets conflict if they are in the same row or column with no wall or outpost between them.
+// Checks if outpost turret requirements are met.
 // ------------------------
-bool isTurretConflict(int r, int c, const vector<vector<int>>& placedTurrets) {
-    for (int d = 0; d < 4; d++) {
-        int nr = r, nc = c;
-        while (true) {
-            nr += dr[d];
-            nc += dc[d];
-            if (!isValid(nr, nc) || grid[nr][nc] == '#' || (grid[nr][nc] >= '0' && grid[nr][nc] <= '4'))
-                break;
-            if (placedTurrets[nr][nc] == 1)
-                return true;
-        }
+bool validOutpostPlacement() {
+    for (const Outpost& op : outposts) {
+        int count = 0;
+        for (int d = 0; d < 4; d++)
+            count += test(placed, op.p + step[d]);
+        if (count != op.req)
+            return false;
     }
-    return false;
+    return true;
 }
 
 // ------------------------
 // Backtracking function to try turret placements.
+// A turret at p would conflict with one already placed exactly when they share a row
+// or column run, i.e. when p is already covered.
 // ------------------------
-void solve(int idx, int turretCount, vector<vector<int>>& placedTurrets, vector<vector<bool>>& tempCovered) {
+void solve(int idx, int turretCount) {
     if (turretCount >= minTurrets)
         return; // Prune if we already exceed current minimum
 
     if (idx == R * C) { // Reached end of grid
-        if (validOutpostPlacement(placedTurrets) && allCovered(tempCovered))
+        if (validOutpostPlacement() && allCovered())
             minTurrets = turretCount;
         return;
     }
 
-    int r = idx / C, c = idx % C;
+    int p = (idx / C + 1) * W + idx % C + 1;
 
     // Skip walls and outposts
-    if (grid[r][c] == '#' || (grid[r][c] >= '0' && grid[r][c] <= '4')) {
-        solve(idx + 1, turretCount, placedTurrets, tempCovered);
+    if (board[p] != '.') {
+        solve(idx + 1, turretCount);
         return;
     }
 
     // Option 1: Do not place a turret here
-    solve(idx + 1, turretCount, placedTurrets, tempCovered);
+    solve(idx + 1, turretCount);
 
     // Option 2: Place a turret here if it does not conflict with others
-    if (!isTurretConflict(r, c, placedTurrets)) {
-        vector<vector<bool>> newCovered = tempCovered;
-        vector<vector<int>> newPlacedTurrets = placedTurrets;
-        newPlacedTurrets[r][c] = 1;
-        placeTurret(r, c, newCovered);
-        solve(idx + 1, turretCount + 1, newPlacedTurrets, newCovered);
+    if (!test(covered, p)) {
+        int mark = trailTop;
+        placeTurret(p);
+        solve(idx + 1, turretCount + 1);
+        removeTurret(p, mark);
     }
 }
 
@@ -138,31 +169,38 @@ int main() {
     ios::sync_with_stdio(false);
     cin.tie(nullptr);
 
-    int T;
-    cin >> T;
+    int T = readInt();
 
     while (T--) {
-        cin >> R >> C;
-        grid.resize(R);
-        covered.assign(R, vector<bool>(C, false));
-        requiredTurrets.assign(R, vector<int>(C, 0));
+        R = readInt();
+        C = readInt();
+        W = C + 2;
+        int cells = (R + 2) * W, words = (cells + 63) / 64;
+        board.assign(cells, '#');
+        covered.assign(words, 0);
+        placed.assign(words, 0);
+        emptyCells.assign(words, 0);
+        trail.assign(cells, 0);
+        trailTop = 0;
         outposts.clear();
+        step[0] = -1, step[1] = -W, step[2] = 1, step[3] = W;
 
         for (int r = 0; r < R; r++) {
-            cin >> grid[r];
             for (int c = 0; c < C; c++) {
-                if (grid[r][c] >= '0' && grid[r][c] <= '4') {
-                    requiredTurrets[r][c] = grid[r][c] - '0';
-                    outposts.push_back({ r, c });
-                }
+                int p = (r + 1) * W + c + 1;
+                char ch = c == 0 ? nextToken() : nextByte();
+                board[p] = ch;
+                if (ch == '.')
+                    setBit(emptyCells, p);
+                else if (ch >= '0' && ch <= '4')
+                    outposts.push_back({ p, ch - '0' });
             }
         }
 
         // Initialize minimum turret count to a large number
         minTurrets = INF;
 
-        vector<vector<int>> placedTurrets(R, vector<int>(C, 0));
-        solve(0, 0, placedTurrets, covered);
+        solve(0, 0);
 
         // Print result
         if (minTurrets == INF)